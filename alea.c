@@ -0,0 +1,99 @@
+#include <math.h>
+#include "alea.h"
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64, utilisé uniquement pour étaler la graine sur les 256 bits d'état.
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void Alea_init(Alea *g, uint64_t graine, int flux) {
+    uint64_t x = graine;
+    for (int i = 0; i < 4; ++i)
+        g->s[i] = splitmix64(&x);
+    for (int i = 0; i < flux; ++i)
+        Alea_saut(g);
+}
+
+// Étape élémentaire sur un état donné. Factorisée pour que les
+// fonctions par lot gardent l'état dans des variables locales.
+static inline uint64_t suivant(uint64_t s[4]) {
+    const uint64_t res = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return res;
+}
+
+// Les 53 bits de poids fort donnent un double uniforme dans [0,1[.
+static inline double versReel(uint64_t x) {
+    return (x >> 11) * 0x1.0p-53;
+}
+
+void Alea_saut(Alea *g) {
+    static const uint64_t SAUT[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i)
+        for (int b = 0; b < 64; ++b) {
+            if (SAUT[i] & ((uint64_t) 1 << b))
+                for (int k = 0; k < 4; ++k)
+                    s[k] ^= g->s[k];
+            suivant(g->s);
+        }
+    for (int k = 0; k < 4; ++k)
+        g->s[k] = s[k];
+}
+
+uint64_t Alea_u64(Alea *g) {
+    return suivant(g->s);
+}
+
+double Alea_uniforme(Alea *g) {
+    return versReel(suivant(g->s));
+}
+
+double Alea_intervalle(Alea *g, double a, double b) {
+    return a + (b - a) * Alea_uniforme(g);
+}
+
+double Alea_normale(Alea *g, double mu, double sigma) {
+    double z;
+    Alea_normales(g, &z, 1, mu, sigma);
+    return z;
+}
+
+void Alea_uniformes(Alea *g, double *T, int n, double a, double b) {
+    uint64_t s[4] = {g->s[0], g->s[1], g->s[2], g->s[3]};
+    double l = b - a;
+    for (int i = 0; i < n; ++i)
+        T[i] = a + l * versReel(suivant(s));
+    for (int k = 0; k < 4; ++k)
+        g->s[k] = s[k];
+}
+
+void Alea_normales(Alea *g, double *T, int n, double mu, double sigma) {
+    uint64_t s[4] = {g->s[0], g->s[1], g->s[2], g->s[3]};
+    for (int i = 0; i < n; i += 2) {
+        // 1 - u est dans ]0,1], ce qui évite log(0).
+        double u1 = 1.0 - versReel(suivant(s));
+        double u2 = versReel(suivant(s));
+        double r = sigma * sqrt(-2.0 * log(u1));
+        double t = 2.0 * 3.14159265358979323846 * u2;
+        T[i] = mu + r * cos(t);
+        if (i + 1 < n)
+            T[i + 1] = mu + r * sin(t);
+    }
+    for (int k = 0; k < 4; ++k)
+        g->s[k] = s[k];
+}
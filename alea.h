@@ -0,0 +1,61 @@
+#ifndef _ALEA_H_
+#define _ALEA_H_
+
+#include <stdint.h>
+
+/**
+   Générateur pseudo-aléatoire xoshiro256** (Blackman & Vigna). L'état
+   tient sur 4 mots de 64 bits, et chaque tirage ne coûte que quelques
+   décalages et multiplications. Contrairement à rand(), il n'y a pas
+   d'état global: chaque thread (ou chaque émetteur) possède son propre
+   générateur, et donc son propre flux.
+*/
+typedef struct SAlea {
+    uint64_t s[4];
+} Alea;
+
+/**
+   Initialise le générateur \a g avec la graine \a graine sur le flux
+   numéro \a flux. Deux flux différents d'une même graine sont séparés
+   de 2^128 tirages: ils ne se recouvrent jamais en pratique. On donne
+   typiquement un flux différent à chaque thread.
+
+   @param g un pointeur vers un générateur.
+   @param graine la graine (la même graine redonne la même suite).
+   @param flux le numéro du flux (0, 1, 2, ...).
+*/
+void Alea_init(Alea *g, uint64_t graine, int flux);
+
+/**
+   Avance le générateur \a g de 2^128 tirages. Permet de passer au flux
+   suivant.
+*/
+void Alea_saut(Alea *g);
+
+/// @return un entier sur 64 bits uniformément distribué.
+uint64_t Alea_u64(Alea *g);
+
+/// @return un réel uniformément distribué dans [0,1[.
+double Alea_uniforme(Alea *g);
+
+/// @return un réel uniformément distribué dans [a,b[.
+double Alea_intervalle(Alea *g, double a, double b);
+
+/// @return un réel suivant une loi normale de moyenne \a mu et d'écart-type \a sigma.
+double Alea_normale(Alea *g, double mu, double sigma);
+
+/**
+   Remplit le tableau \a T avec \a n réels uniformément distribués dans [a,b[.
+   Bien plus rapide que \a n appels à Alea_intervalle, car l'état reste
+   dans les registres pendant toute la boucle.
+*/
+void Alea_uniformes(Alea *g, double *T, int n, double a, double b);
+
+/**
+   Remplit le tableau \a T avec \a n réels suivant une loi normale de
+   moyenne \a mu et d'écart-type \a sigma (Box-Muller, deux valeurs par
+   paire de tirages uniformes).
+*/
+void Alea_normales(Alea *g, double *T, int n, double mu, double sigma);
+
+#endif
@@ -1,20 +1,8 @@
 #include <stdlib.h>
+#include <assert.h>
+#include <math.h>
 #include "arbre.h"
-
-
-/**
- * Copie une donnée dans une autre. Cette fonction est utile lorsque
- * le type ValType est complexe et que l'opérateur d'affectation du C
- * ne fonctionne pas bien.
- *
- * @param d1 un pointeur vers la première donnée à recopier.  
- *
- * @param d2 un pointeur vers la deuxième donnée, qui sera écrasée et
- * prendra les valeurs de d1.
- */
-void CopierDonnees(Donnee *d1, Donnee *d2) {
-    *d2 = *d1;
-}
+#include "tableau.h"
 
 
 /**
@@ -38,24 +26,25 @@ void Detruire(Arbre *A) {
 }
 
 /**
- * Crée et retourne un arbre avec un seul noeud qui recopie la donnée
- * pointée par ptr_d.
+ * Crée et retourne un arbre avec un seul noeud, de clé (x, indice).
  *
- * @param ptr_d un pointeur vers une donnée.
+ * @param x la position de la donnée.
+ * @param indice l'indice de la donnée dans son tableau.
  *
  * @return un pointeur vers l'arbre créé (ie. un pointeur vers sa
  * racine).
  */
-extern Arbre *Creer0(Donnee *ptr_d) {
-    return Creer2(ptr_d, ArbreVide(), ArbreVide());
+extern Arbre *Creer0(const Reel x[DIM], int indice) {
+    return Creer2(x, indice, ArbreVide(), ArbreVide());
 }
 
 
 /**
  * Crée et retourne un arbre qui l'union de deux sous-arbres plus un
- * noeud qui recopie la donnée pointée par ptr_d.
+ * noeud de clé (x, indice).
  *
- * @param ptr_d un pointeur vers une donnée.
+ * @param x la position de la donnée.
+ * @param indice l'indice de la donnée dans son tableau.
  *
  * @param G un pointeur vers le futur sous-arbre gauche. Attention il
  * ne faut plus s'en servir après, car il est intégré à l'arbre A.
@@ -66,9 +55,12 @@ extern Arbre *Creer0(Donnee *ptr_d) {
  * @return un pointeur vers l'arbre créé (ie. un pointeur vers sa
  * racine).
  */
-Arbre *Creer2(Donnee *ptr_d, Arbre *G, Arbre *D) {
+Arbre *Creer2(const Reel x[DIM], int indice, Arbre *G, Arbre *D) {
     Noeud *racine = (Noeud *) malloc(sizeof(Noeud));
-    CopierDonnees(ptr_d, &racine->data);
+    for (int a = 0; a < DIM; ++a)
+        racine->x[a] = x[a];
+    racine->indice = indice;
+    racine->supprime = 0;
     racine->gauche = G;
     racine->droit = D;
     return racine;
@@ -133,55 +125,295 @@ void ModifieDroit(Noeud *N, Arbre *SD) {
 }
 
 /**
- * Permet la lecture et l'écriture dans la donnée associée au noeud N.
+ * @return un pointeur vers la position (la clé) du noeud N.
  *
- * @return un pointeur vers la donnee du noeud N.
+ * @param N un pointeur vers un noeud valide.
+ */
+const Reel *Position(const Noeud *N) {
+    return N->x;
+}
+
+/**
+ * @return l'indice, dans son tableau, de la donnée du noeud N.
  *
  * @param N un pointeur vers un noeud valide.
  */
-Donnee *Valeur(Noeud *N) {
-    return &N->data;
+int Indice(const Noeud *N) {
+    return N->indice;
 }
 
-int comp(void *d1, void *d2, void *a) {
-    int axe = *((int *) a);
-    Donnee *D1 = (Donnee *) d1;
-    Donnee *D2 = (Donnee *) d2;
+void Arene_init(Arene *ar) {
+    ar->taille = 0;
+    ar->nb = 0;
+    ar->noeuds = NULL;
+    ar->blocs = NULL;
+    ar->taille_elements = 0;
+    ar->elements = NULL;
+    ar->ordonnanceur = NULL;
+}
 
-    if (D1->x[axe] < D2->x[axe])
-        return -1;
-    else if (D1->x[axe] > D2->x[axe])
-        return 1;
-    else // D1->x[axe] == D2->x[axe]
-        return 0;
+void Arene_parallele(Arene *ar, Ordonnanceur *O) {
+    ar->ordonnanceur = O;
 }
 
-Arbre *KDT_Creer(Donnee *T, int i, int j, int a) {
-    if (i > j)
-        return NULL;
+void Arene_reserve(Arene *ar, int n) {
+    assert(ar->nb == 0);
+    ar->noeuds = Tableau_reserve(ar->noeuds, &ar->taille, 0, n, sizeof(Noeud));
+}
 
-    if (i == j)
-        return Creer0(&T[i]);
+Noeud *Arene_noeud(Arene *ar) {
+    if (ar->nb < ar->taille)
+        return ar->noeuds + ar->nb++;
+    if (ar->blocs == NULL || ar->blocs->nb == ARENE_BLOC) {
+        BlocNoeuds *b = (BlocNoeuds *) malloc(sizeof(BlocNoeuds));
+        b->suivant = ar->blocs;
+        b->nb = 0;
+        ar->blocs = b;
+    }
+    return ar->blocs->noeuds + ar->blocs->nb++;
+}
+
+void Arene_vide(Arene *ar) {
+    ar->nb = 0;
+    while (ar->blocs != NULL) {
+        BlocNoeuds *b = ar->blocs;
+        ar->blocs = b->suivant;
+        free(b);
+    }
+}
 
-    qsort_r(T + i, j - i + 1, sizeof(Donnee), comp, &a);
+void Arene_termine(Arene *ar) {
+    Arene_vide(ar);
+    Tableau_libere(ar->noeuds, &ar->taille, sizeof(Noeud));
+    ar->nb = 0;
+    ar->noeuds = NULL;
+    Tableau_libere(ar->elements, &ar->taille_elements, sizeof(ElementKD));
+    ar->elements = NULL;
+}
+
+ElementKD *Arene_elements(Arene *ar, int n) {
+    ar->elements = Tableau_reserve(ar->elements, &ar->taille_elements, 0, n, sizeof(ElementKD));
+    return ar->elements;
+}
 
+static inline void echangeElements(ElementKD *E, int i, int j) {
+    ElementKD e = E[i];
+    E[i] = E[j];
+    E[j] = e;
+}
+
+// Réordonne E[i..j] pour que E[m] soit à la place qu'il aurait si
+// E[i..j] était trié selon l'axe a: les éléments avant lui ne sont pas
+// plus grands, ceux après lui pas plus petits (sélection de Hoare). La
+// comparaison est écrite sur place, sans appel de fonction.
+static void selectionne(ElementKD *E, int i, int j, int m, int a) {
+    while (i < j) {
+        Reel pivot = E[(i + j) / 2].x[a];
+        int g = i, d = j;
+        while (g <= d) {
+            while (E[g].x[a] < pivot) ++g;
+            while (E[d].x[a] > pivot) --d;
+            if (g <= d)
+                echangeElements(E, g++, d--);
+        }
+        // Maintenant E[i..d] <= pivot <= E[g..j], et E[d+1..g-1] == pivot.
+        if (m <= d)
+            j = d;
+        else if (m >= g)
+            i = g;
+        else
+            return;
+    }
+}
+
+/// Ce qu'il faut pour construire un sous-arbre, éventuellement dans une tâche.
+typedef struct SConstruction {
+    Ordonnanceur *O; //< NULL pour construire sans tâches
+    Noeud *N;        //< la place de la racine du sous-arbre
+    ElementKD *E;
+    int i;
+    int j;
+    int a;
+} Construction;
+
+// Construit l'arbre des clés E[i..j] (i <= j) dans les j-i+1 noeuds à
+// partir de N, en ordre préfixe: la racine en N, le sous-arbre gauche
+// juste derrière, puis le droit. La place de chaque sous-arbre est connue
+// d'avance, si bien que les deux sous-arbres peuvent être construits en
+// même temps. Au-dessus de KDT_SEUIL_PARALLELE clés, le sous-arbre droit
+// est lancé comme une tâche.
+static void construit(void *arg) {
+    const Construction *c = (const Construction *) arg;
+    ElementKD *E = c->E;
+    int i = c->i, j = c->j, a = c->a;
     int m = (i + j) / 2;
-    Arbre *A = Creer0(&T[m]);
-    ModifieGauche(Racine(A), KDT_Creer(T, i, m - 1, (a + 1) % DIM));
-    ModifieDroit(Racine(A), KDT_Creer(T, m + 1, j, (a + 1) % DIM));
+    selectionne(E, i, j, m, a);
 
-    return A;
+    Noeud *N = c->N;
+    for (int k = 0; k < DIM; ++k)
+        N->x[k] = E[m].x[k];
+    N->indice = E[m].indice;
+    N->supprime = 0;
+    N->gauche = i <= m - 1 ? N + 1 : ArbreVide();
+    N->droit = m + 1 <= j ? N + 1 + (m - i) : ArbreVide();
+
+    int b = (a + 1) % DIM;
+    Construction gauche = {c->O, N->gauche, E, i, m - 1, b};
+    Construction droite = {c->O, N->droit, E, m + 1, j, b};
+    if (c->O != NULL && j - i + 1 > KDT_SEUIL_PARALLELE) {
+        GroupeTaches G;
+        GroupeTaches_init(&G);
+        if (N->droit != ArbreVide())
+            Ordonnanceur_lance(c->O, &G, construit, &droite);
+        if (N->gauche != ArbreVide())
+            construit(&gauche);
+        Ordonnanceur_attend(c->O, &G);
+    } else {
+        if (N->gauche != ArbreVide())
+            construit(&gauche);
+        if (N->droit != ArbreVide())
+            construit(&droite);
+    }
+}
+
+Arbre *KDT_Creer(Arene *ar, ElementKD *E, int i, int j, int a) {
+    if (i > j)
+        return ArbreVide();
+    int n = j - i + 1;
+    assert(ar->nb + n <= ar->taille);
+    // Les noeuds sont pris d'un coup dans l'arène, en ordre préfixe.
+    Construction c = {ar->ordonnanceur, ar->noeuds + ar->nb, E, i, j, a};
+    ar->nb += n;
+    construit(&c);
+    return c.N;
+}
+
+Arbre *KDT_ConstruitElements(Arene *ar, int n) {
+    assert(n <= ar->taille_elements);
+    Arene_vide(ar);
+    Arene_reserve(ar, n);
+    return KDT_Creer(ar, ar->elements, 0, n - 1, 0);
+}
+
+Noeud *KDT_Insere(Arene *ar, Arbre **A, const Reel x[DIM], int indice) {
+    Noeud *N = Arene_noeud(ar);
+    for (int k = 0; k < DIM; ++k)
+        N->x[k] = x[k];
+    N->indice = indice;
+    N->supprime = 0;
+    N->gauche = ArbreVide();
+    N->droit = ArbreVide();
+    Noeud **place = A;
+    int a = 0;
+    while (*place != ArbreVide()) {
+        Noeud *P = *place;
+        place = x[a] < P->x[a] ? &P->gauche : &P->droit;
+        a = (a + 1) % DIM;
+    }
+    *place = N;
+    return N;
+}
+
+// Un tas max borné: le plus lointain des candidats est en tête.
+typedef struct STasVoisins {
+    int k;
+    int nb;
+    Noeud **res;
+    double *dist;
+} TasVoisins;
+
+static void echangeVoisins(TasVoisins *t, int i, int j) {
+    Noeud *o = t->res[i];
+    double d = t->dist[i];
+    t->res[i] = t->res[j];
+    t->dist[i] = t->dist[j];
+    t->res[j] = o;
+    t->dist[j] = d;
 }
 
-void KDT_PointsDansBoule(TabObstacles *F, Noeud *N, Point *p, double r, int a) {
-    if (N != NULL) {
-        Obstacle *o = Valeur(N);
-        if (distance(p->x[0], p->x[1], o->x[0], o->x[1]) < r)
-            TabObstacles_ajoute(F, *o);
+static void descendVoisins(TasVoisins *t, int i, int nb) {
+    for (;;) {
+        int g = 2 * i + 1, d = g + 1, m = i;
+        if (g < nb && t->dist[g] > t->dist[m]) m = g;
+        if (d < nb && t->dist[d] > t->dist[m]) m = d;
+        if (m == i) return;
+        echangeVoisins(t, i, m);
+        i = m;
+    }
+}
 
-        if (p->x[a] <= o->x[a] + r)
-            KDT_PointsDansBoule(F, Gauche(N), p, r, (a + 1) % DIM);
-        if (p->x[a] >= o->x[a] - r)
-            KDT_PointsDansBoule(F, Droit(N), p, r, (a + 1) % DIM);
+// Propose le noeud o à distance d: il entre dans le tas s'il reste de
+// la place ou s'il est plus proche que le plus lointain.
+static void proposeVoisin(TasVoisins *t, Noeud *o, double d) {
+    if (t->nb < t->k) {
+        int i = t->nb++;
+        t->res[i] = o;
+        t->dist[i] = d;
+        while (i > 0 && t->dist[(i - 1) / 2] < t->dist[i]) {
+            echangeVoisins(t, i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    } else if (d < t->dist[0]) {
+        t->res[0] = o;
+        t->dist[0] = d;
+        descendVoisins(t, 0, t->nb);
     }
 }
+
+// Rayon de recherche courant: la distance du k-ième meilleur candidat.
+static double pireVoisin(TasVoisins *t) {
+    return t->nb < t->k ? HUGE_VAL : t->dist[0];
+}
+
+static void KDT_KPlusProchesRec(TasVoisins *t, Noeud *N, const Point *p, int a) {
+    if (N == NULL) return;
+    if (!N->supprime)
+        proposeVoisin(t, N, distanceCoord(p->x, N->x));
+    double ecart = p->x[a] - N->x[a];
+    Noeud *proche = ecart <= 0.0 ? Gauche(N) : Droit(N);
+    Noeud *loin = ecart <= 0.0 ? Droit(N) : Gauche(N);
+    KDT_KPlusProchesRec(t, proche, p, (a + 1) % DIM);
+    if (fabs(ecart) < pireVoisin(t))
+        KDT_KPlusProchesRec(t, loin, p, (a + 1) % DIM);
+}
+
+int KDT_KPlusProches(Noeud *N, const Point *p, int k, Noeud **res, double *dist) {
+    TasVoisins t = {k, 0, res, dist};
+    if (k <= 0) return 0;
+    KDT_KPlusProchesRec(&t, N, p, 0);
+    // Tri par tas sur place: du plus proche au plus lointain.
+    for (int n = t.nb - 1; n > 0; --n) {
+        echangeVoisins(&t, 0, n);
+        descendVoisins(&t, 0, n);
+    }
+    return t.nb;
+}
+
+Noeud *KDT_PlusProche(Noeud *N, const Point *p, double *d) {
+    Noeud *o = NULL;
+    *d = HUGE_VAL;
+    KDT_KPlusProches(N, p, 1, &o, d);
+    return o;
+}
+
+void TabIndices_init(TabIndices *tab) {
+    tab->taille = 0;
+    tab->nb = 0;
+    tab->indices = NULL;
+}
+
+void TabIndices_ajoute(TabIndices *tab, int i) {
+    if (tab->nb == tab->taille)
+        tab->indices = Tableau_agrandir(tab->indices, &tab->taille, tab->nb, sizeof(int));
+    tab->indices[tab->nb++] = i;
+}
+
+void TabIndices_vide(TabIndices *tab) {
+    tab->nb = 0;
+}
+
+void TabIndices_termine(TabIndices *tab) {
+    Tableau_libere(tab->indices, &tab->taille, sizeof(int));
+    tab->nb = 0;
+    tab->indices = NULL;
+}
@@ -2,37 +2,39 @@
 #define _ARBRE_H_
 
 #include "obstacles.h"
+#include "particules.h"
+#include "ordonnanceur.h"
 #include "stdio.h"
 
 
-/* A vous de changer cela. */
-typedef Obstacle Donnee;
-
-/**
- * Copie une donnée dans une autre. Cette fonction est utile lorsque
- * le type Donnee est complexe et que l'opérateur d'affectation du C
- * ne fonctionne pas bien.
- *
- * @param d1 un pointeur vers la première donnée à recopier.  
- *
- * @param d2 un pointeur vers la deuxième donnée, qui sera écrasée et
- * prendra les valeurs de d1.
- */
-extern void CopierDonnees(Donnee *d1, Donnee *d2);
-
-
 /*****************************************************************************/
 /* Les arbres */
 /*****************************************************************************/
 
 /**
- * Un noeud dans un arbre binaire contient une donnée, et
+ * Un arbre k-D ne stocke pas les données elles-mêmes, mais des clés:
+ * la position d'une donnée et son indice dans le tableau d'où elle
+ * vient. Le même arbre peut ainsi indexer des obstacles, des
+ * particules, ou n'importe quoi qui a une position, et un noeud reste
+ * petit quel que soit le type des données. Les versions typées des
+ * fonctions (construction depuis un tableau, recherches qui rangent
+ * les données trouvées) sont générées par KDT_DEFINIT, plus bas.
+ */
+typedef struct SElementKD {
+    Reel x[DIM]; //< la position de la donnée
+    int indice;  //< l'indice de la donnée dans son tableau
+} ElementKD;
+
+/**
+ * Un noeud dans un arbre binaire contient une clé, et
  * éventuellement un pointeur vers un fils gauche et/ou vers un fils
  * droit.  On pourrait aussi stocker le noeud père ici, mais on ne
  * s'en servira pas dans les algorithmes développés.
  */
 typedef struct SNoeud {
-    Donnee data;
+    Reel x[DIM];   //< la position de la donnée
+    int indice;    //< indice de la donnée dans le tableau d'où elle vient (-1 si inconnu)
+    int supprime;  //< vrai si le noeud est une "pierre tombale": il ne sert plus qu'à guider la recherche
     struct SNoeud *gauche;
     struct SNoeud *droit;
 } Noeud;
@@ -59,21 +61,22 @@ extern Arbre *ArbreVide();
 extern void Detruire(Arbre *A);
 
 /**
- * Crée et retourne un arbre avec un seul noeud qui recopie la donnée
- * pointée par ptr_d.
+ * Crée et retourne un arbre avec un seul noeud, de clé (x, indice).
  *
- * @param ptr_d un pointeur vers une donnée.
+ * @param x la position de la donnée.
+ * @param indice l'indice de la donnée dans son tableau.
  *
  * @return un pointeur vers l'arbre créé (ie. un pointeur vers sa
  * racine).
  */
-extern Arbre *Creer0(Donnee *ptr_d);
+extern Arbre *Creer0(const Reel x[DIM], int indice);
 
 /**
  * Crée et retourne un arbre qui l'union de deux sous-arbres plus un
- * noeud qui recopie la donnée pointée par ptr_d.
+ * noeud de clé (x, indice).
  *
- * @param ptr_d un pointeur vers une donnée.
+ * @param x la position de la donnée.
+ * @param indice l'indice de la donnée dans son tableau.
  *
  * @param G un pointeur vers le futur sous-arbre gauche. Attention il
  * ne faut plus s'en servir après, car il est intégré à l'arbre A.
@@ -84,7 +87,7 @@ extern Arbre *Creer0(Donnee *ptr_d);
  * @return un pointeur vers l'arbre créé (ie. un pointeur vers sa
  * racine).
  */
-extern Arbre *Creer2(Donnee *ptr_d, Arbre *G, Arbre *D);
+extern Arbre *Creer2(const Reel x[DIM], int indice, Arbre *G, Arbre *D);
 
 /**
  * Retourne le noeud racine de A (éventuellement NULL si arbre vide).
@@ -129,27 +132,281 @@ extern void ModifieDroit(Noeud *N, Arbre *SD);
 
 
 /**
- * Permet la lecture et l'écriture dans la donnée associée au noeud N.
+ * @return un pointeur vers la position (la clé) du noeud N.
  *
- * @return un pointeur vers la donnee du noeud N.
+ * @param N un pointeur vers un noeud valide.
+ */
+extern const Reel *Position(const Noeud *N);
+
+/**
+ * @return l'indice, dans son tableau, de la donnée du noeud N.
  *
  * @param N un pointeur vers un noeud valide.
  */
-extern Donnee *Valeur(Noeud *N);
+extern int Indice(const Noeud *N);
+
+
+/*****************************************************************************/
+/* L'arène de noeuds */
+/*****************************************************************************/
+
+// Nombre de noeuds des blocs supplémentaires d'une arène.
+#define ARENE_BLOC 1024
+
+/// Un bloc de noeuds ajouté à une arène pleine (insertions).
+typedef struct SBlocNoeuds {
+    struct SBlocNoeuds *suivant;
+    int nb;
+    Noeud noeuds[ARENE_BLOC];
+} BlocNoeuds;
+
+/**
+ * Une arène est un bloc contigu de noeuds, qui appartient à un arbre
+ * k-D. Les noeuds y sont pris les uns après les autres (en ordre
+ * préfixe lors de la construction), ce qui fait qu'un fils gauche suit
+ * directement son père en mémoire. Construire l'arbre coûte une seule
+ * allocation, et le détruire consiste juste à vider l'arène.
+ *
+ * Les noeuds insérés après la construction (KDT_Insere) sont pris dans
+ * des blocs supplémentaires chaînés, pour que les noeuds déjà
+ * distribués ne bougent jamais.
+ *
+ * Attention: un arbre construit dans une arène ne doit pas être passé
+ * à Detruire, ModifieGauche ou ModifieDroit.
+ */
+typedef struct SArene {
+    int taille;
+    int nb;
+    Noeud *noeuds;
+    BlocNoeuds *blocs; //< les blocs supplémentaires, le plus récent d'abord
+    int taille_elements;
+    ElementKD *elements; //< les clés à ranger lors de la prochaine construction
+    Ordonnanceur *ordonnanceur; //< pour construire en parallèle (NULL: un seul fil)
+} Arene;
+
+/**
+ * Initialise une arène vide.
+ *
+ * @param ar un pointeur vers une arène.
+ */
+extern void Arene_init(Arene *ar);
+
+/**
+ * Les prochaines constructions d'arbres dans l'arène \a ar se feront en
+ * parallèle avec l'ordonnanceur \a O (NULL pour revenir à un seul fil).
+ *
+ * @param ar un pointeur vers une arène valide.
+ * @param O un pointeur vers un ordonnanceur, ou NULL.
+ */
+extern void Arene_parallele(Arene *ar, Ordonnanceur *O);
+
+/**
+ * Garantit que l'arène peut fournir \a n noeuds. Ne doit être appelée
+ * que sur une arène vide, car les noeuds peuvent être déplacés.
+ *
+ * @param ar un pointeur vers une arène valide et vide.
+ * @param n le nombre de noeuds voulus.
+ */
+extern void Arene_reserve(Arene *ar, int n);
 
+/**
+ * @return un nouveau noeud pris dans l'arène \a ar, non initialisé.
+ * Si le bloc principal est plein, le noeud est pris dans un bloc
+ * supplémentaire.
+ *
+ * @param ar un pointeur vers une arène valide.
+ */
+extern Noeud *Arene_noeud(Arene *ar);
+
+/**
+ * Rend d'un coup tous les noeuds de l'arène (en O(1) s'il n'y a pas eu
+ * d'insertions depuis la construction). Tous les arbres
+ * construits dans l'arène deviennent invalides. La mémoire est gardée
+ * pour la prochaine construction.
+ *
+ * @param ar un pointeur vers une arène valide.
+ */
+extern void Arene_vide(Arene *ar);
+
+/**
+ * Libère la mémoire de l'arène.
+ *
+ * @param ar un pointeur vers une arène valide.
+ */
+extern void Arene_termine(Arene *ar);
+
+
+/**
+ * @return un tableau de \a n clés, à remplir avant d'appeler
+ * KDT_ConstruitElements. Le tableau appartient à l'arène et sert à
+ * toutes ses constructions.
+ *
+ * @param ar un pointeur vers une arène valide.
+ * @param n le nombre de clés à ranger.
+ */
+extern ElementKD *Arene_elements(Arene *ar, int n);
+
+// Si E est un tableau de clés, i < j désignent les positions de début
+// et de fin dans E, a est l'axe utilisé pour découper l'espace. Alors
+// cette fonction crée et retourne l'arbre binaire (arbre k-D) stockant
+// les clés E[i], ..., E[j]. E est réordonné: à chaque niveau, on ne
+// trie pas, on sélectionne seulement la médiane selon l'axe a (en
+// O(j-i) en moyenne). Les noeuds sont pris d'un coup dans le bloc
+// principal de l'arène \a ar, qui doit avoir assez de place (j-i+1
+// noeuds). Si l'arène a un ordonnanceur, les sous-arbres de plus de
+// KDT_SEUIL_PARALLELE clés sont construits en parallèle.
+Arbre *KDT_Creer(Arene *ar, ElementKD *E, int i, int j, int a);
+
+// Vide l'arène \a ar et y construit l'arbre k-D des \a n clés
+// préalablement rangées dans Arene_elements(ar, n). C'est la façon
+// normale de (re)construire un arbre: une seule allocation de noeuds
+// au plus, aucune désallocation.
+Arbre *KDT_ConstruitElements(Arene *ar, int n);
+
+// Insère la clé (x, indice) comme nouvelle feuille de l'arbre *A, en
+// descendant depuis la racine comme une recherche. Coûte
+// O(profondeur), mais déséquilibre peu à peu l'arbre: il faut le
+// reconstruire de temps en temps.
+// Retourne le noeud créé.
+Noeud *KDT_Insere(Arene *ar, Arbre **A, const Reel x[DIM], int indice);
+
+// Les recherches ci-dessous ignorent les noeuds supprimés.
+
+// Retourne le noeud de l'arbre de racine N dont la clé est la plus
+// proche du point p, ou NULL si l'arbre est vide, et met sa distance à
+// p dans *d. Les
+// sous-arbres sont visités du côté de p d'abord, et l'autre côté n'est
+// visité que si le plan de coupe est plus proche que la meilleure
+// clé trouvée jusque-là.
+Noeud *KDT_PlusProche(Noeud *N, const Point *p, double *d);
+
+// Cherche les k clés de l'arbre de racine N les plus proches du
+// point p. Leurs noeuds sont rangés dans res, du
+// plus proche au plus lointain, et leurs distances à p dans dist (res
+// et dist ont au moins k cases). Les candidats sont gardés dans un tas
+// max de taille k pendant la recherche, ce qui permet d'élaguer dès
+// que le plan de coupe est plus loin que le k-ième meilleur.
+// Retourne le nombre de noeuds trouvés (k, ou moins si l'arbre a
+// moins de k noeuds).
+int KDT_KPlusProches(Noeud *N, const Point *p, int k, Noeud **res, double *dist);
+
+// Nombre de clés au-dessous duquel un sous-arbre est construit par un
+// seul fil: en dessous, lancer une tâche coûte plus qu'elle ne rapporte.
+#define KDT_SEUIL_PARALLELE 4096
+
+// Nombre maximal de points d'un paquet pour KDT_DansBoulePaquet.
+#define KDT_PAQUET 32
+
+
+/*****************************************************************************/
+/* Les versions typées */
+/*****************************************************************************/
+
+/**
+ * Un tableau dynamique d'indices, pour ranger le résultat d'une
+ * recherche sans recopier les données trouvées.
+ */
+typedef struct STabIndices {
+    int taille;
+    int nb;
+    int *indices;
+} TabIndices;
+
+void TabIndices_init(TabIndices *tab);
+void TabIndices_ajoute(TabIndices *tab, int i);
+void TabIndices_vide(TabIndices *tab);
+void TabIndices_termine(TabIndices *tab);
+
+/**
+ * Génère les fonctions de l'arbre k-D propres à un type de données
+ * \a Type, qui doit avoir un champ Reel x[DIM] (sa position):
+ *
+ * - KDT_ConstruitNom(ar, T, n) construit l'arbre des n données T[0..n-1];
+ * - KDT_InsereNom(ar, &A, T, i) insère la donnée T[i];
+ * - KDT_DansBouleNom(F, T, N, p, r, a) ajoute dans le tableau F (de
+ *   type \a TabRes) les données à une distance inférieure à r du point
+ *   p. Le paramètre a désigne l'axe courant et change à chaque niveau
+ *   de récursion;
+ * - KDT_DansBoulePaquetNom(F, T, N, P, n, r, bmin, bmax, a) fait la même
+ *   chose pour un paquet de n points proches les uns des autres
+ *   (n <= KDT_PAQUET), de boîte englobante [bmin,bmax]: F[k] reçoit les
+ *   données proches de P[k]. L'arbre n'est parcouru qu'une fois pour
+ *   tout le paquet, en élaguant avec la boîte; les points ne sont testés
+ *   un à un que sur les noeuds dont la clé est dans la boîte élargie de r.
+ *
+ * Une donnée trouvée est rangée par AJOUTE(F, T, i), où i est son
+ * indice dans T. Les fonctions générées sont inline: lecture des
+ * positions et ajout au résultat se font sans pointeur de fonction.
+ * Les recherches ignorent les noeuds supprimés.
+ */
+#define KDT_DEFINIT(Nom, Type, TabRes, AJOUTE)                                      \
+static inline Arbre *KDT_Construit##Nom(Arene *ar, const Type *T, int n) {          \
+    ElementKD *E = Arene_elements(ar, n);                                          \
+    for (int k = 0; k < n; ++k) {                                                  \
+        for (int a = 0; a < DIM; ++a)                                              \
+            E[k].x[a] = T[k].x[a];                                                 \
+        E[k].indice = k;                                                           \
+    }                                                                              \
+    return KDT_ConstruitElements(ar, n);                                           \
+}                                                                                  \
+                                                                                   \
+static inline Noeud *KDT_Insere##Nom(Arene *ar, Arbre **A, const Type *T, int i) { \
+    return KDT_Insere(ar, A, T[i].x, i);                                           \
+}                                                                                  \
+                                                                                   \
+static inline void KDT_DansBoule##Nom(TabRes *F, const Type *T, Noeud *N,          \
+                                      const Point *p, double r, int a) {           \
+    if (N != NULL) {                                                               \
+        if (!N->supprime && distanceCoord(p->x, N->x) < r)                         \
+            AJOUTE(F, T, N->indice);                                               \
+        if (p->x[a] <= N->x[a] + r)                                                \
+            KDT_DansBoule##Nom(F, T, N->gauche, p, r, (a + 1) % DIM);              \
+        if (p->x[a] >= N->x[a] - r)                                                \
+            KDT_DansBoule##Nom(F, T, N->droit, p, r, (a + 1) % DIM);               \
+    }                                                                              \
+}                                                                                  \
+                                                                                   \
+static inline void KDT_DansBoulePaquet##Nom(TabRes *F, const Type *T, Noeud *N,    \
+                                            const Point *P, int n, double r,       \
+                                            const Reel bmin[DIM],                  \
+                                            const Reel bmax[DIM], int a) {         \
+    while (N != NULL) {                                                            \
+        int dedans = 1;                                                            \
+        for (int k = 0; k < DIM; ++k)                                              \
+            dedans = dedans && N->x[k] >= bmin[k] - r && N->x[k] <= bmax[k] + r;   \
+        if (dedans && !N->supprime)                                                \
+            for (int k = 0; k < n; ++k)                                            \
+                if (distanceCoord(P[k].x, N->x) < r)                               \
+                    AJOUTE(&F[k], T, N->indice);                                   \
+        int g = bmin[a] <= N->x[a] + r;                                            \
+        int d = bmax[a] >= N->x[a] - r;                                            \
+        int b = (a + 1) % DIM;                                                     \
+        /* On ne récurse que si les deux côtés sont visités; sinon on */           \
+        /* continue la descente sur place. */                                      \
+        if (g && d)                                                                \
+            KDT_DansBoulePaquet##Nom(F, T, N->gauche, P, n, r, bmin, bmax, b);     \
+        N = d ? N->droit : (g ? N->gauche : NULL);                                 \
+        a = b;                                                                     \
+    }                                                                              \
+}
 
-// Si T est un Obstacle* pointant vers la première case d'un tableau
-// d'Obstacle, i < j désignent les indices de début et de fin dans le
-// tableau T, a est l'axe (0 ou 1) utilisé pour découper le plan.
-// Alors cette fonction crée et retourne l'arbre binaire (arbre k-D)
-// stockant tous les obstacles spécifiés.
-Arbre *KDT_Creer(Donnee *T, int i, int j, int a);
+// Les obstacles trouvés sont recopiés dans un TabObstacles, où les BVH
+// ajoutent ensuite les leurs.
+#define KDT_AJOUTE_OBSTACLE(F, T, i) TabObstacles_ajoute(F, (T)[i])
+KDT_DEFINIT(Obstacles, Obstacle, TabObstacles, KDT_AJOUTE_OBSTACLE)
 
-// Ajoute dans le tableau d'obstacles F les obstacles de l'arbre
-// désigné par le noeud racine N qui sont à une distance inférieure à
-// r du point p. Le paramètre a désigne l'axe courant (0 ou 1) et
-// change à chaque niveau de récursion.
-void KDT_PointsDansBoule(TabObstacles *F, Noeud *N, Point *p, double r, int a);
+// Pour les particules, on ne range que les indices: les voisins se
+// lisent ensuite directement dans le tableau de particules. C'est le
+// point d'entrée des recherches de voisines: pour un TabParticules P,
+//
+//   Arbre *A = KDT_ConstruitParticules(&arene, P->particules, TabParticules_nb(P));
+//   KDT_DansBouleParticules(&V, P->particules, Racine(A), &p, r, 0);
+//
+// range dans le TabIndices V les indices des particules à moins de r
+// de p. L'arbre ne retient que les positions au moment de la
+// construction: il est à reconstruire après chaque déplacement.
+#define KDT_AJOUTE_INDICE(F, T, i) TabIndices_ajoute(F, i)
+KDT_DEFINIT(Particules, Particule, TabIndices, KDT_AJOUTE_INDICE)
 
 
 #endif
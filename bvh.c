@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <math.h>
+#include "bvh.h"
+#include "tableau.h"
+
+void BVH_init(BVH *B, TabObstacles *O) {
+    B->O = O;
+    B->noeuds = NULL;
+    B->nb_noeuds = 0;
+    B->taille_noeuds = 0;
+    B->indices = NULL;
+    B->taille_indices = 0;
+    B->aire_construction = 0.0;
+    B->nb_obstacles = 0;
+}
+
+// Boîte englobante de l'obstacle o, réunie avec [bmin,bmax].
+static void englobe(const Obstacle *o, double bmin[DIM], double bmax[DIM]) {
+    double omin[DIM], omax[DIM];
+    Obstacle_boite(o, omin, omax);
+    for (int a = 0; a < DIM; ++a) {
+        bmin[a] = fmin(bmin[a], omin[a]);
+        bmax[a] = fmax(bmax[a], omax[a]);
+    }
+}
+
+// Vrai si le point p est à distance inférieure à r de l'obstacle o: exact
+// pour un disque, par sa boîte englobante pour les obstacles étendus.
+static int proche(const Obstacle *o, const Point *p, double r) {
+    if (o->type == DISQUE)
+        return distanceCoord(p->x, o->x) < r + o->r;
+    double omin[DIM], omax[DIM], d2 = 0.0;
+    Obstacle_boite(o, omin, omax);
+    for (int a = 0; a < DIM; ++a) {
+        double e = fmax(fmax(omin[a] - p->x[a], p->x[a] - omax[a]), 0.0);
+        d2 += e * e;
+    }
+    return d2 < r * r;
+}
+
+static void boiteVide(double bmin[DIM], double bmax[DIM]) {
+    for (int a = 0; a < DIM; ++a) {
+        bmin[a] = HUGE_VAL;
+        bmax[a] = -HUGE_VAL;
+    }
+}
+
+// Aire de la boîte en 2D, volume en 3D.
+static double aire(const NoeudBVH *N) {
+    double a = 1.0;
+    for (int k = 0; k < DIM; ++k)
+        a *= N->bmax[k] - N->bmin[k];
+    return a;
+}
+
+// Double du centre de la boîte de l'obstacle o selon l'axe a.
+static double centre2(const Obstacle *o, int a) {
+    return o->x[a] + o->x2[a];
+}
+
+// Permute indices[i..j] (bornes comprises) pour que indices[m] soit à la
+// place qu'il aurait si les obstacles étaient triés selon le centre de
+// leur boîte sur l'axe a: ceux avant lui ne sont pas plus grands, ceux
+// après lui pas plus petits (sélection de Hoare, comme dans arbre.c).
+static void selectionne(int *indices, const Obstacle *T, int i, int j, int m, int a) {
+    while (i < j) {
+        double pivot = centre2(T + indices[(i + j) / 2], a);
+        int g = i, d = j;
+        while (g <= d) {
+            while (centre2(T + indices[g], a) < pivot) ++g;
+            while (centre2(T + indices[d], a) > pivot) --d;
+            if (g <= d) {
+                int t = indices[g];
+                indices[g++] = indices[d];
+                indices[d--] = t;
+            }
+        }
+        if (m <= d)
+            j = d;
+        else if (m >= g)
+            i = g;
+        else
+            return;
+    }
+}
+
+// Construit le sous-arbre des obstacles indices[i..j[ et retourne l'indice de sa racine.
+static int construit(BVH *B, int i, int j) {
+    int k = B->nb_noeuds++;
+    NoeudBVH *N = B->noeuds + k;
+    boiteVide(N->bmin, N->bmax);
+    for (int l = i; l < j; ++l)
+        englobe(TabObstacles_ref(B->O, B->indices[l]), N->bmin, N->bmax);
+    if (j - i <= BVH_FEUILLE) {
+        N->debut = i;
+        N->nb = j - i;
+        N->droit = -1;
+        return k;
+    }
+    // Coupe au milieu selon l'axe le plus long de la boîte.
+    // Une sélection suffit: il n'y a pas besoin de trier chaque moitié.
+    int axe = 0;
+    for (int a = 1; a < DIM; ++a)
+        if (N->bmax[a] - N->bmin[a] > N->bmax[axe] - N->bmin[axe])
+            axe = a;
+    int m = (i + j) / 2;
+    selectionne(B->indices, B->O->obstacles, i, j - 1, m, axe);
+    N->nb = 0;
+    N->debut = i;
+    construit(B, i, m);
+    int d = construit(B, m, j);
+    N->droit = d;
+    return k;
+}
+
+void BVH_Construit(BVH *B) {
+    int n = TabObstacles_nb(B->O);
+    // Un arbre binaire à feuilles non vides a moins de 2n noeuds.
+    B->noeuds = Tableau_reserve(B->noeuds, &B->taille_noeuds, 0, 2 * n + 1, sizeof(NoeudBVH));
+    B->indices = Tableau_reserve(B->indices, &B->taille_indices, 0, n, sizeof(int));
+    for (int k = 0; k < n; ++k)
+        B->indices[k] = k;
+    B->nb_noeuds = 0;
+    B->aire_construction = 0.0;
+    B->nb_obstacles = n;
+    if (n == 0) return;
+    construit(B, 0, n);
+    for (int k = 0; k < B->nb_noeuds; ++k)
+        B->aire_construction += aire(B->noeuds + k);
+}
+
+void BVH_Reajuste(BVH *B) {
+    if (B->nb_obstacles != TabObstacles_nb(B->O)) {
+        // Des obstacles ont été ajoutés ou retirés: la hiérarchie est à refaire.
+        BVH_Construit(B);
+        return;
+    }
+    double total = 0.0;
+    // Les fils sont après leur père: en remontant le tableau, ils sont déjà à jour.
+    for (int k = B->nb_noeuds - 1; k >= 0; --k) {
+        NoeudBVH *N = B->noeuds + k;
+        boiteVide(N->bmin, N->bmax);
+        if (N->nb > 0)
+            for (int l = N->debut; l < N->debut + N->nb; ++l)
+                englobe(TabObstacles_ref(B->O, B->indices[l]), N->bmin, N->bmax);
+        else
+            for (int a = 0; a < DIM; ++a) {
+                const NoeudBVH *G = N + 1, *D = B->noeuds + N->droit;
+                N->bmin[a] = fmin(G->bmin[a], D->bmin[a]);
+                N->bmax[a] = fmax(G->bmax[a], D->bmax[a]);
+            }
+        total += aire(N);
+    }
+    if (total > 2.0 * B->aire_construction)
+        BVH_Construit(B);
+}
+
+// La boîte [bmin-r,bmax+r] rencontre-t-elle celle du noeud N ?
+static int rencontre(const NoeudBVH *N, const Reel bmin[DIM], const Reel bmax[DIM], double r) {
+    for (int a = 0; a < DIM; ++a)
+        if (N->bmin[a] > bmax[a] + r || N->bmax[a] < bmin[a] - r)
+            return 0;
+    return 1;
+}
+
+void BVH_DansBoulePaquet(BVH *B, TabObstacles *F, const Point *P, int n, double r,
+                         const Reel bmin[DIM], const Reel bmax[DIM]) {
+    if (B->nb_noeuds == 0) return;
+    int pile[64];
+    int sommet = 0;
+    pile[sommet++] = 0;
+    while (sommet > 0) {
+        const NoeudBVH *N = B->noeuds + pile[--sommet];
+        if (!rencontre(N, bmin, bmax, r))
+            continue;
+        if (N->nb == 0) {
+            pile[sommet++] = N->droit;
+            pile[sommet++] = N - B->noeuds + 1;
+            continue;
+        }
+        // Feuille: chaque point du paquet est testé contre chaque obstacle.
+        for (int l = N->debut; l < N->debut + N->nb; ++l) {
+            Obstacle *o = TabObstacles_ref(B->O, B->indices[l]);
+            for (int k = 0; k < n; ++k)
+                if (proche(o, &P[k], r))
+                    TabObstacles_ajoute(&F[k], *o);
+        }
+    }
+}
+
+void BVH_termine(BVH *B) {
+    Tableau_libere(B->noeuds, &B->taille_noeuds, sizeof(NoeudBVH));
+    Tableau_libere(B->indices, &B->taille_indices, sizeof(int));
+    BVH_init(B, B->O);
+}
@@ -0,0 +1,69 @@
+#ifndef _BVH_H_
+#define _BVH_H_
+
+#include "points.h"
+#include "obstacles.h"
+
+/// Nombre maximal d'obstacles dans une feuille de la hiérarchie.
+#define BVH_FEUILLE 4
+
+/**
+   Un noeud de la hiérarchie de volumes englobants. Les noeuds sont
+   rangés en ordre préfixe dans un seul tableau: le fils gauche d'un
+   noeud interne est le noeud suivant, et ses deux fils ont toujours un
+   indice plus grand que lui.
+*/
+typedef struct SNoeudBVH {
+    double bmin[DIM]; //< coin inférieur de la boîte englobante
+    double bmax[DIM]; //< coin supérieur de la boîte englobante
+    int droit;        //< indice du fils droit (noeud interne)
+    int debut;        //< première case de la feuille dans BVH.indices
+    int nb;           //< nombre d'obstacles de la feuille (0 pour un noeud interne)
+} NoeudBVH;
+
+/**
+   Une hiérarchie de volumes englobants (BVH) sur les obstacles d'un
+   tableau, adaptée aux obstacles qui bougent à chaque pas de temps.
+   Contrairement à l'arbre k-D, on ne la reconstruit pas quand les
+   obstacles bougent: on réajuste seulement ses boîtes, de bas en haut,
+   en O(n) (BVH_Reajuste). Quand les boîtes sont devenues trop grandes
+   par rapport à la construction, elle se reconstruit d'elle-même.
+*/
+typedef struct SBVH {
+    TabObstacles *O;   //< les obstacles (le tableau n'appartient pas au BVH)
+    NoeudBVH *noeuds;
+    int nb_noeuds;
+    int taille_noeuds;
+    int *indices;      //< indices des obstacles, regroupés par feuille
+    int taille_indices;
+    double aire_construction; //< somme des aires des boîtes juste après la construction
+    int nb_obstacles;  //< nombre d'obstacles lors de la construction
+} BVH;
+
+/// Initialise une hiérarchie vide sur le tableau d'obstacles \a O.
+void BVH_init(BVH *B, TabObstacles *O);
+
+/// Reconstruit entièrement la hiérarchie sur les obstacles actuels (coupes médianes).
+void BVH_Construit(BVH *B);
+
+/**
+   Recalcule les boîtes après un déplacement des obstacles, sans changer
+   la hiérarchie, sauf si les boîtes sont devenues deux fois plus grandes
+   qu'à la construction, ou si le nombre d'obstacles a changé: elle est
+   alors reconstruite.
+*/
+void BVH_Reajuste(BVH *B);
+
+/**
+   Version par paquet de la recherche: pour chaque k < n, ajoute dans
+   F[k] les obstacles à une distance inférieure à r du point P[k] (pour
+   un segment, une capsule ou une boîte, on mesure la distance à sa
+   boîte englobante, et l'on peut donc avoir quelques faux positifs). [bmin,bmax] est la boîte englobante des n points.
+*/
+void BVH_DansBoulePaquet(BVH *B, TabObstacles *F, const Point *P, int n, double r,
+                         const Reel bmin[DIM], const Reel bmax[DIM]);
+
+/// Libère la mémoire de la hiérarchie (mais pas le tableau d'obstacles).
+void BVH_termine(BVH *B);
+
+#endif
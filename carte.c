@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "carte.h"
+
+// Le niveau de densité d'un pixel qui ne contient qu'une particule:
+// les particules isolées restent visibles.
+#define CARTE_DENSITE_MIN (CARTE_NIVEAUX / 2)
+
+// Convertit une composante dans [0,1] en octet.
+static uint32_t octet(double c) {
+    return (uint32_t) (c * 255.0 + 0.5);
+}
+
+void Carte_init(Carte *C, const double c1[3], const double c2[3]) {
+    C->largeur = 0;
+    C->hauteur = 0;
+    C->taille = 0;
+    C->nb_max = 0;
+    C->nb = NULL;
+    C->vitesse = NULL;
+    C->pixels = NULL;
+    for (int d = 0; d < CARTE_NIVEAUX; ++d)
+        for (int l = 0; l < CARTE_NIVEAUX; ++l) {
+            double lambda = (double) l / (CARTE_NIVEAUX - 1);
+            double intensite = (double) d / (CARTE_NIVEAUX - 1);
+            uint32_t rgb = 0;
+            for (int k = 0; k < 3; ++k) {
+                double c = (1 - lambda) * c1[k] + lambda * c2[k];
+                rgb = (rgb << 8) | octet((1 - intensite) + intensite * c);
+            }
+            C->lut[d * CARTE_NIVEAUX + l] = rgb;
+        }
+}
+
+void Carte_efface(Carte *C, int largeur, int hauteur) {
+    int nb_pixels = largeur * hauteur;
+    if (nb_pixels > C->taille) {
+        free(C->nb);
+        free(C->vitesse);
+        free(C->pixels);
+        C->nb = (int *) malloc(nb_pixels * sizeof(int));
+        C->vitesse = (float *) malloc(nb_pixels * sizeof(float));
+        C->pixels = (uint32_t *) malloc(nb_pixels * sizeof(uint32_t));
+        C->taille = nb_pixels;
+    }
+    C->largeur = largeur;
+    C->hauteur = hauteur;
+    C->nb_max = 0;
+    memset(C->nb, 0, nb_pixels * sizeof(int));
+    memset(C->vitesse, 0, nb_pixels * sizeof(float));
+}
+
+void Carte_ajoute(Carte *C, const ParticuleTrame *P, int n, const double echelle[2], const double origine[2]) {
+    // Compte les particules de chaque pixel: O(n).
+    int largeur = C->largeur, hauteur = C->hauteur;
+    int nb_max = C->nb_max;
+    for (int i = 0; i < n; ++i) {
+        double px = P[i].x * echelle[0] + origine[0];
+        double py = P[i].y * echelle[1] + origine[1];
+        if (px < 0.0 || py < 0.0 || px >= largeur || py >= hauteur)
+            continue;
+        int k = (int) py * largeur + (int) px;
+        C->vitesse[k] += P[i].v;
+        if (++C->nb[k] > nb_max)
+            nb_max = C->nb[k];
+    }
+    C->nb_max = nb_max;
+}
+
+void Carte_colorie(Carte *C, double vMax) {
+    // Colorie chaque pixel par la table: O(pixels).
+    int nb_pixels = C->largeur * C->hauteur;
+    int nb_max = C->nb_max;
+    double norme = nb_max > 1 ? (CARTE_NIVEAUX - 1 - CARTE_DENSITE_MIN) / log((double) nb_max) : 0.0;
+    double par_vitesse = (CARTE_NIVEAUX - 1) / vMax;
+    for (int k = 0; k < nb_pixels; ++k) {
+        int nb = C->nb[k];
+        if (nb == 0) {
+            C->pixels[k] = 0xffffff;
+            continue;
+        }
+        int d = CARTE_DENSITE_MIN + (int) (log((double) nb) * norme);
+        int l = (int) (C->vitesse[k] / nb * par_vitesse);
+        C->pixels[k] = C->lut[d * CARTE_NIVEAUX + (l < CARTE_NIVEAUX ? l : CARTE_NIVEAUX - 1)];
+    }
+}
+
+void Carte_termine(Carte *C) {
+    free(C->nb);
+    free(C->vitesse);
+    free(C->pixels);
+    C->nb = NULL;
+    C->vitesse = NULL;
+    C->pixels = NULL;
+    C->taille = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef _CARTE_H_
+#define _CARTE_H_
+
+#include <stdint.h>
+#include "trame.h"
+
+/// Nombre de niveaux de la table des couleurs, en vitesse comme en densité.
+#define CARTE_NIVEAUX 64
+
+/**
+   Une carte de densité et de vitesse des particules, à la résolution de
+   l'écran: chaque pixel compte les particules qui y tombent et la somme
+   de leurs vitesses. Sa couleur va du blanc (vide) vers la couleur de
+   la vitesse moyenne (de \a c1 pour les lentes à \a c2 pour les
+   rapides), d'autant plus saturée qu'il y a de particules (échelle
+   logarithmique). Les couleurs viennent d'une table précalculée
+   (CARTE_NIVEAUX x CARTE_NIVEAUX).
+
+   Le coût est en O(n + pixels), quel que soit le nombre de particules
+   qui se superposent: c'est l'affichage pour les très grands nombres de
+   particules, où dessiner chaque disque est lent et illisible.
+*/
+typedef struct SCarte {
+    int largeur;
+    int hauteur;
+    int taille;          //< capacité des tableaux, en pixels
+    int nb_max;          //< le plus grand nombre de particules d'un pixel
+    int *nb;             //< nombre de particules de chaque pixel
+    float *vitesse;      //< somme des vitesses des particules de chaque pixel
+    uint32_t *pixels;    //< l'image, ligne par ligne, au format 0x00RRGGBB (CAIRO_FORMAT_RGB24)
+    uint32_t lut[CARTE_NIVEAUX * CARTE_NIVEAUX]; //< lut[densité * CARTE_NIVEAUX + vitesse]
+} Carte;
+
+/**
+   Initialise une carte vide, avec le dégradé de vitesse de \a c1 (vitesse
+   nulle) à \a c2 (vitesse maximale), en rgb dans [0,1].
+*/
+void Carte_init(Carte *C, const double c1[3], const double c2[3]);
+
+/// Commence une image vide de \a largeur x \a hauteur pixels.
+void Carte_efface(Carte *C, int largeur, int hauteur);
+
+/**
+   Ajoute à l'image les \a n particules \a P. La particule de position
+   (x,y) tombe dans le pixel (echelle[0] x + origine[0], echelle[1] y +
+   origine[1]); celles qui tombent hors de l'image sont ignorées. On
+   peut ajouter les particules en plusieurs fois (par exemple seulement
+   celles des cellules visibles d'une trame).
+*/
+void Carte_ajoute(Carte *C, const ParticuleTrame *P, int n, const double echelle[2], const double origine[2]);
+
+/**
+   Calcule la couleur des pixels à partir des particules ajoutées. La
+   couleur de vitesse sature à \a vMax.
+
+   Les lignes de C->pixels font 4 * largeur octets.
+*/
+void Carte_colorie(Carte *C, double vMax);
+
+/// Libère la mémoire de la carte.
+void Carte_termine(Carte *C);
+
+#endif
@@ -0,0 +1,186 @@
+#include <math.h>
+#include "collisions.h"
+
+static Point versPoint(const Reel x[DIM]) {
+    Point p;
+    for (int k = 0; k < DIM; ++k)
+        p.x[k] = x[k];
+    return p;
+}
+
+// Le point du segment [a,b] le plus proche de x.
+static Point plusProcheSurSegment(Point a, Point b, Point x) {
+    Point ab = Point_sub(b, a);
+    double l2 = Point_norm2(ab);
+    double t = l2 > 0.0 ? Point_dot(Point_sub(x, a), ab) / l2 : 0.0;
+    t = fmin(fmax(t, 0.0), 1.0);
+    return Point_add(a, Point_mul(t, ab));
+}
+
+#if DIM == 2
+// Produit vectoriel (composante z) de ab et ac.
+static double orientation(Point a, Point b, Point c) {
+    Point ab = Point_sub(b, a), ac = Point_sub(c, a);
+    return ab.x[0] * ac.x[1] - ab.x[1] * ac.x[0];
+}
+
+// Normale unitaire au segment [a,b], du côté du point x.
+static Point normaleSegment(Point a, Point b, Point x) {
+    Point n;
+    n.x[0] = a.x[1] - b.x[1];
+    n.x[1] = b.x[0] - a.x[0];
+    n = Point_normalize(n);
+    return Point_dot(Point_sub(x, a), n) >= 0.0 ? n : Point_mul(-1.0, n);
+}
+#endif
+
+int Obstacle_touche(const Obstacle *o, const Particule *p, double dt) {
+    Point x = versPoint(p->x);
+    Point a = versPoint(o->x), b = versPoint(o->x2);
+    switch (o->type) {
+        case DISQUE:
+            return distanceCoord(p->x, o->x) <= o->r;
+        case CAPSULE:
+            return Point_distance(x, plusProcheSurSegment(a, b, x)) <= o->r;
+        case BOITE:
+            for (int k = 0; k < DIM; ++k)
+                if (p->x[k] < o->x[k] || p->x[k] > o->x2[k])
+                    return 0;
+            return 1;
+        case SEGMENT: {
+#if DIM == 2
+            Point xd = Point_add(x, Point_mul(dt, versPoint(p->v)));
+            // Les extrémités de chaque segment sont de part et d'autre de l'autre.
+            return orientation(a, b, x) * orientation(a, b, xd) <= 0.0
+                   && orientation(x, xd, a) * orientation(x, xd, b) <= 0.0
+                   && orientation(a, b, x) != 0.0;
+#else
+            // Dans l'espace, un segment sans épaisseur n'arrête rien.
+            return 0;
+#endif
+        }
+    }
+    return 0;
+}
+
+Particule calculRebond(Particule p, const Obstacle *o, double dt) {
+    Point x = versPoint(p.x);
+    Point vo = versPoint(o->v);
+    Point a = versPoint(o->x), b = versPoint(o->x2);
+    // Calcule la nouvelle position xd (sans collision) et le vecteur vitesse relative.
+    Point v = Point_sub(versPoint(p.v), vo);
+    Point xd = Point_add(x, Point_mul(dt, versPoint(p.v)));
+    Point q, u; // point de la surface le plus proche de xd, et normale sortante en q
+    double e;   // enfoncement de xd dans l'obstacle (négatif s'il est dehors)
+    switch (o->type) {
+        case DISQUE:
+        case CAPSULE: {
+            Point s = o->type == DISQUE ? a : plusProcheSurSegment(a, b, xd);
+            double l = Point_distance(xd, s);
+            if (l > 0.0)
+                u = Point_mul(1.0 / l, Point_sub(xd, s));
+            else // xd est sur l'axe: on renvoie la particule d'où elle vient
+                u = Point_normalize(Point_mul(-1.0, v));
+            q = Point_add(s, Point_mul(o->r, u));
+            e = o->r - l;
+            break;
+        }
+#if DIM == 2
+        case SEGMENT: {
+            u = normaleSegment(a, b, x);
+            double l = Point_dot(Point_sub(xd, a), u);
+            q = Point_sub(xd, Point_mul(l, u));
+            e = -l;
+            break;
+        }
+#endif
+        case BOITE: {
+            int dedans = 1;
+            for (int k = 0; k < DIM; ++k) {
+                q.x[k] = fmin(fmax(xd.x[k], a.x[k]), b.x[k]);
+                dedans = dedans && q.x[k] == xd.x[k];
+            }
+            if (!dedans) {
+                double l = Point_distance(xd, q);
+                u = Point_mul(1.0 / l, Point_sub(xd, q));
+                e = -l;
+            } else {
+                // On ressort par la face la plus proche.
+                int axe = 0;
+                double s = -1.0;
+                e = HUGE_VAL;
+                for (int k = 0; k < DIM; ++k) {
+                    if (xd.x[k] - a.x[k] < e) { e = xd.x[k] - a.x[k]; axe = k; s = -1.0; }
+                    if (b.x[k] - xd.x[k] < e) { e = b.x[k] - xd.x[k]; axe = k; s = 1.0; }
+                }
+                for (int k = 0; k < DIM; ++k)
+                    u.x[k] = k == axe ? s : 0.0;
+                q = xd;
+                q.x[axe] = s > 0.0 ? b.x[axe] : a.x[axe];
+            }
+            break;
+        }
+        default:
+            return p;
+    }
+    return calculRebondNormal(p, q, u, e, o->att, vo);
+}
+
+Particule calculRebondNormal(Particule p, Point q, Point u, double e, double att, Point vo) {
+    Point v = Point_sub(versPoint(p.v), vo);
+    Point xm = Point_add(q, Point_mul(att * e, u));
+    double proj_v = Point_dot(v, u);
+    // réalise le rebond si la particule est bien en train de rentrer dans l'obstacle.
+    if (proj_v < 0.0)
+        v = Point_sub(v, Point_mul(2.0 * proj_v, u));
+    Particule p_out = p;
+    for (int k = 0; k < DIM; ++k) {
+        p_out.x[k] = xm.x[k];
+        p_out.v[k] = vo.x[k] + att * v.x[k];
+    }
+    return p_out;
+}
+
+double Obstacle_distance(const Obstacle *o, Point x, Point *grad) {
+    Point a = versPoint(o->x), b = versPoint(o->x2);
+    double d;
+    switch (o->type) {
+        case BOITE: {
+            // Distance au rectangle: dehors, au point le plus proche; dedans, à la face la plus proche.
+            Point q;
+            int dedans = 1;
+            for (int k = 0; k < DIM; ++k) {
+                q.x[k] = fmin(fmax(x.x[k], a.x[k]), b.x[k]);
+                dedans = dedans && q.x[k] == x.x[k];
+            }
+            if (!dedans) {
+                d = Point_distance(x, q);
+                *grad = Point_mul(1.0 / d, Point_sub(x, q));
+                return d;
+            }
+            d = -HUGE_VAL;
+            for (int k = 0; k < DIM; ++k) {
+                double dm = a.x[k] - x.x[k], dp = x.x[k] - b.x[k];
+                if (dm > d || dp > d) {
+                    for (int l = 0; l < DIM; ++l)
+                        grad->x[l] = 0.0;
+                    grad->x[k] = dm > dp ? -1.0 : 1.0;
+                    d = fmax(dm, dp);
+                }
+            }
+            return d;
+        }
+        default: {
+            // Un segment est une capsule de rayon nul.
+            Point s = o->type == DISQUE ? a : plusProcheSurSegment(a, b, x);
+            double r = o->type == SEGMENT ? 0.0 : o->r;
+            d = Point_distance(x, s);
+            if (d > 0.0)
+                *grad = Point_mul(1.0 / d, Point_sub(x, s));
+            else
+                for (int k = 0; k < DIM; ++k)
+                    grad->x[k] = k == DIM - 1 ? 1.0 : 0.0;
+            return d - r;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef _COLLISIONS_H_
+#define _COLLISIONS_H_
+
+#include "particules.h"
+#include "obstacles.h"
+
+/**
+   Indique si la particule \a p, qui va passer de p->x à p->x + dt p->v,
+   touche l'obstacle \a o. Pour un DISQUE, une CAPSULE ou une BOITE, la
+   particule doit être dans l'obstacle; pour un SEGMENT, qui n'a pas
+   d'épaisseur, son déplacement doit le traverser.
+*/
+int Obstacle_touche(const Obstacle *o, const Particule *p, double dt);
+
+/**
+   Calcule le rebond de la particule \a p sur l'obstacle \a o, qu'elle
+   touche. On cherche le point q de la surface de l'obstacle le plus
+   proche de la position prédite xd = p.x + dt p.v, et la normale
+   sortante u en q. La particule est replacée en q + att * e * u, où e
+   est l'enfoncement de xd dans l'obstacle, et sa vitesse relative à
+   l'obstacle est réfléchie (si elle rentre dans l'obstacle) puis
+   atténuée par att. Si l'obstacle se déplace à la vitesse o->v, elle
+   est rajoutée ensuite (une palette en mouvement lance donc la
+   particule).
+
+   @return la particule après le rebond.
+*/
+Particule calculRebond(Particule p, const Obstacle *o, double dt);
+
+/**
+   Fin commune de tous les rebonds: la particule est replacée en
+   q + att * e * u, où q est le point de la surface le plus proche de sa
+   position prédite, u la normale sortante en q et e l'enfoncement, et
+   sa vitesse relative à la surface (qui va à la vitesse \a vo) est
+   réfléchie puis atténuée par \a att.
+*/
+Particule calculRebondNormal(Particule p, Point q, Point u, double e, double att, Point vo);
+
+/**
+   Distance signée du point \a x à l'obstacle \a o: négative dedans,
+   positive dehors (toujours positive pour un SEGMENT). \a grad reçoit
+   son gradient, la normale sortante de la surface la plus proche.
+*/
+double Obstacle_distance(const Obstacle *o, Point x, Point *grad);
+
+#endif
@@ -0,0 +1,28 @@
+#include "commandes.h"
+
+void FileCommandes_init(FileCommandes *F) {
+    F->tete = 0;
+    F->queue = 0;
+}
+
+int FileCommandes_envoie(FileCommandes *F, const Commande *c) {
+    unsigned q = __atomic_load_n(&F->queue, __ATOMIC_RELAXED);
+    unsigned t = __atomic_load_n(&F->tete, __ATOMIC_ACQUIRE);
+    if (q - t == FILE_COMMANDES_TAILLE)
+        return 0;
+    F->commandes[q & (FILE_COMMANDES_TAILLE - 1)] = *c;
+    // La commande est écrite avant que le consommateur ne voie la nouvelle queue.
+    __atomic_store_n(&F->queue, q + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int FileCommandes_recoit(FileCommandes *F, Commande *c) {
+    unsigned t = __atomic_load_n(&F->tete, __ATOMIC_RELAXED);
+    unsigned q = __atomic_load_n(&F->queue, __ATOMIC_ACQUIRE);
+    if (t == q)
+        return 0;
+    *c = F->commandes[t & (FILE_COMMANDES_TAILLE - 1)];
+    // La place n'est rendue au producteur qu'une fois la commande lue.
+    __atomic_store_n(&F->tete, t + 1, __ATOMIC_RELEASE);
+    return 1;
+}
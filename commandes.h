@@ -0,0 +1,63 @@
+#ifndef _COMMANDES_H_
+#define _COMMANDES_H_
+
+#include "points.h"
+
+/**
+   Les commandes envoyées par l'interface au fil de simulation. Les
+   coordonnées sont déjà converties en coordonnées réelles.
+*/
+typedef enum {
+    CMD_CLIC,    //< clic du bouton \a bouton en \a p (sélection, création ou suppression d'obstacle)
+    CMD_GLISSE,  //< la souris, bouton gauche enfoncé, est en \a p
+    CMD_LACHE,   //< le bouton gauche est relâché
+    CMD_SDF      //< active (\a actif vrai) ou non les collisions par le champ de distance
+} TypeCommande;
+
+typedef struct SCommande {
+    TypeCommande type;
+    Point p;
+    int bouton;
+    double force;  //< atténuation d'un obstacle créé par un clic
+    double rayon;  //< un clic à moins de \a rayon d'un obstacle le touche (la taille de son dessin)
+    int actif;
+} Commande;
+
+/// Capacité de la file de commandes (une puissance de 2).
+#define FILE_COMMANDES_TAILLE 256
+
+/**
+   Une file de commandes sans verrou pour un seul producteur (le fil de
+   l'interface) et un seul consommateur (le fil de simulation). Chacun
+   n'écrit que son propre indice: le producteur avance \a queue après
+   avoir écrit la commande (publication), le consommateur avance \a tete
+   après l'avoir lue. Les deux indices sont sur des lignes de cache
+   différentes pour que les deux fils ne se gênent pas.
+*/
+typedef struct SFileCommandes {
+    unsigned tete;          //< prochaine commande à lire (écrit par le consommateur)
+    char pad1[64 - sizeof(unsigned)];
+    unsigned queue;         //< prochaine place libre (écrit par le producteur)
+    char pad2[64 - sizeof(unsigned)];
+    Commande commandes[FILE_COMMANDES_TAILLE];
+} FileCommandes;
+
+/// Initialise une file vide.
+void FileCommandes_init(FileCommandes *F);
+
+/**
+   Ajoute la commande \a c à la file (producteur seulement).
+
+   @return 1 si la commande a été ajoutée, 0 si la file est pleine.
+*/
+int FileCommandes_envoie(FileCommandes *F, const Commande *c);
+
+/**
+   Retire la plus ancienne commande de la file et la met dans *c
+   (consommateur seulement).
+
+   @return 1 si une commande a été lue, 0 si la file est vide.
+*/
+int FileCommandes_recoit(FileCommandes *F, Commande *c);
+
+#endif
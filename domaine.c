@@ -0,0 +1,56 @@
+#include <math.h>
+#include <string.h>
+#include "domaine.h"
+
+void Domaine_init(Domaine *D, double xmin, double ymin, double xmax, double ymax,
+                  TypeBord bx, TypeBord by) {
+    D->bmin[0] = fmin(xmin, xmax);
+    D->bmin[1] = fmin(ymin, ymax);
+    D->bmax[0] = fmax(xmin, xmax);
+    D->bmax[1] = fmax(ymin, ymax);
+    D->bord[0] = bx;
+    D->bord[1] = by;
+    // En 3D, les axes suivants reprennent les bornes et le bord de l'axe y.
+    for (int a = 2; a < DIM; ++a) {
+        D->bmin[a] = D->bmin[1];
+        D->bmax[a] = D->bmax[1];
+        D->bord[a] = by;
+    }
+}
+
+int Domaine_applique(const Domaine *D, Particule *p) {
+    for (int a = 0; a < DIM; ++a) {
+        double lo = D->bmin[a], hi = D->bmax[a];
+        if (p->x[a] >= lo && p->x[a] <= hi)
+            continue;
+        switch (D->bord[a]) {
+            case BORD_OUVERT:
+                return 0;
+            case BORD_PERIODIQUE: {
+                double l = hi - lo;
+                p->x[a] = lo + fmod(p->x[a] - lo, l);
+                if (p->x[a] < lo) p->x[a] += l;
+                break;
+            }
+            case BORD_REFLECHISSANT:
+                p->x[a] = p->x[a] < lo ? 2.0 * lo - p->x[a] : 2.0 * hi - p->x[a];
+                // Une particule très rapide pourrait ressortir de l'autre côté.
+                p->x[a] = fmin(fmax(p->x[a], lo), hi);
+                p->v[a] = -p->v[a];
+                break;
+        }
+    }
+    return 1;
+}
+
+int Domaine_lisBord(const char *mot, TypeBord *t) {
+    if (strcmp(mot, "ouvert") == 0)
+        *t = BORD_OUVERT;
+    else if (strcmp(mot, "periodique") == 0)
+        *t = BORD_PERIODIQUE;
+    else if (strcmp(mot, "reflechissant") == 0)
+        *t = BORD_REFLECHISSANT;
+    else
+        return 0;
+    return 1;
+}
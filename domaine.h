@@ -0,0 +1,45 @@
+#ifndef _DOMAINE_H_
+#define _DOMAINE_H_
+
+#include "points.h"
+#include "particules.h"
+
+/// Ce qui arrive à une particule qui franchit un bord du domaine.
+typedef enum {
+    BORD_OUVERT,       //< elle sort et est détruite
+    BORD_PERIODIQUE,   //< elle réapparaît du côté opposé
+    BORD_REFLECHISSANT //< elle rebondit sur le bord, sans perte
+} TypeBord;
+
+/**
+   Le domaine de simulation: un rectangle [bmin,bmax], avec un type de
+   bord par axe (par exemple périodique en x et réfléchissant en y).
+*/
+typedef struct SDomaine {
+    double bmin[DIM];   //< coin inférieur
+    double bmax[DIM];   //< coin supérieur
+    TypeBord bord[DIM]; //< type des deux bords perpendiculaires à chaque axe
+} Domaine;
+
+/// Initialise le domaine [xmin,xmax]x[ymin,ymax], avec le bord \a bx en x et \a by en y.
+/// En 3D, l'axe z reprend les bornes et le bord de l'axe y.
+void Domaine_init(Domaine *D, double xmin, double ymin, double xmax, double ymax,
+                  TypeBord bx, TypeBord by);
+
+/**
+   Applique les bords du domaine à la particule \a p, qui vient d'être
+   déplacée: elle est ramenée dans le domaine par les bords périodiques
+   et réfléchissants.
+
+   @return 0 si la particule est sortie par un bord ouvert et doit être détruite, 1 sinon.
+*/
+int Domaine_applique(const Domaine *D, Particule *p);
+
+/**
+   Lit un type de bord: "ouvert", "periodique" ou "reflechissant".
+
+   @return 1 si le mot est reconnu (et \a t est rempli), 0 sinon.
+*/
+int Domaine_lisBord(const char *mot, TypeBord *t);
+
+#endif
@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+#include "emetteurs.h"
+#include "tableau.h"
+
+// Nombre de particules dont on tire les paramètres en un seul lot.
+#define LOT 256
+
+void initEmetteur(Emetteur *e, double x, double y, double debit,
+                  double vx, double vy, double m, uint64_t graine, int flux) {
+    e->forme = EMET_POINT;
+    for (int k = 0; k < DIM; ++k)
+        e->x[k] = e->x2[k] = e->v[k] = 0.0;
+    e->x[0] = e->x2[0] = x;
+    e->x[1] = e->x2[1] = y;
+    e->r = 0.0;
+    e->debit = debit;
+    e->v[0] = vx;
+    e->v[1] = vy;
+    e->loi_v = LOI_UNIFORME;
+    e->dv = 0.0;
+    e->m = m;
+    e->dm = 0.0;
+    e->reste = 0.0;
+    Alea_init(&e->alea, graine, flux);
+}
+
+// Tire les positions de n particules selon la forme de l'émetteur.
+static void tirePositions(Emetteur *e, Particule *q, int n) {
+    double u[2 * LOT];
+    switch (e->forme) {
+        case EMET_POINT:
+            for (int i = 0; i < n; ++i)
+                for (int k = 0; k < DIM; ++k)
+                    q[i].x[k] = e->x[k];
+            break;
+        case EMET_LIGNE:
+            Alea_uniformes(&e->alea, u, n, 0.0, 1.0);
+            for (int i = 0; i < n; ++i)
+                for (int k = 0; k < DIM; ++k)
+                    q[i].x[k] = e->x[k] + u[i] * (e->x2[k] - e->x[k]);
+            break;
+        case EMET_DISQUE:
+            // sqrt sur le rayon pour avoir une densité uniforme sur la surface.
+            // Le disque est dans le plan des deux premiers axes.
+            Alea_uniformes(&e->alea, u, 2 * n, 0.0, 1.0);
+            for (int i = 0; i < n; ++i) {
+                double rho = e->r * sqrt(u[2 * i]);
+                double theta = 2.0 * 3.14159265358979323846 * u[2 * i + 1];
+                for (int k = 2; k < DIM; ++k)
+                    q[i].x[k] = e->x[k];
+                q[i].x[0] = e->x[0] + rho * cos(theta);
+                q[i].x[1] = e->x[1] + rho * sin(theta);
+            }
+            break;
+    }
+}
+
+// Tire les vitesses et masses de n particules et remet les forces à zéro.
+static void tireDynamique(Emetteur *e, Particule *q, int n) {
+    double dv[DIM * LOT];
+    double dm[LOT];
+    if (e->loi_v == LOI_NORMALE)
+        Alea_normales(&e->alea, dv, DIM * n, 0.0, e->dv);
+    else
+        Alea_uniformes(&e->alea, dv, DIM * n, -e->dv, e->dv);
+    Alea_uniformes(&e->alea, dm, n, -e->dm, e->dm);
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < DIM; ++k) {
+            q[i].v[k] = e->v[k] + dv[DIM * i + k];
+            q[i].f[k] = 0.0;
+        }
+        q[i].m = fmax(e->m + dm[i], 1e-3);
+    }
+}
+
+int Emetteur_emet(Emetteur *e, TabParticules *P, double dt) {
+    e->reste += e->debit * dt;
+    int n = (int) e->reste;
+    if (n <= 0) return 0;
+    e->reste -= n;
+    Particule *q = TabParticules_ajouteN(P, n);
+    for (int i = 0; i < n; i += LOT) {
+        int k = n - i < LOT ? n - i : LOT;
+        tirePositions(e, q + i, k);
+        tireDynamique(e, q + i, k);
+    }
+    return n;
+}
+
+void TabEmetteurs_init(TabEmetteurs *tab) {
+    tab->taille = 0;
+    tab->nb = 0;
+    tab->emetteurs = NULL;
+}
+
+void TabEmetteurs_ajoute(TabEmetteurs *tab, Emetteur e) {
+    if (tab->nb == tab->taille)
+        TabEmetteurs_agrandir(tab);
+    tab->emetteurs[tab->nb++] = e;
+}
+
+Emetteur *TabEmetteurs_ref(TabEmetteurs *tab, int i) {
+    assert (i < tab->nb);
+    return tab->emetteurs + i;
+}
+
+int TabEmetteurs_nb(TabEmetteurs *tab) {
+    return tab->nb;
+}
+
+void TabEmetteurs_termine(TabEmetteurs *tab) {
+    Tableau_libere(tab->emetteurs, &tab->taille, sizeof(Emetteur));
+    tab->nb = 0;
+    tab->emetteurs = NULL;
+}
+
+void TabEmetteurs_agrandir(TabEmetteurs *tab) {
+    tab->emetteurs = Tableau_agrandir(tab->emetteurs, &tab->taille, tab->nb, sizeof(Emetteur));
+}
@@ -0,0 +1,85 @@
+#ifndef _EMETTEURS_H_
+#define _EMETTEURS_H_
+
+#include <stdint.h>
+#include "points.h"
+#include "particules.h"
+#include "alea.h"
+
+/// La zone dans laquelle un émetteur fait apparaître ses particules.
+typedef enum {
+    EMET_POINT,  //< toutes les particules naissent au point x
+    EMET_LIGNE,  //< uniformément sur le segment [x,x2]
+    EMET_DISQUE  //< uniformément dans le disque de centre x et de rayon r
+} FormeEmetteur;
+
+/// La loi de dispersion de la vitesse initiale autour de sa valeur moyenne.
+typedef enum {
+    LOI_UNIFORME, //< chaque composante varie uniformément dans [-dv,dv]
+    LOI_NORMALE   //< chaque composante suit une loi normale d'écart-type dv
+} LoiAlea;
+
+/**
+   Un émetteur crée des particules à débit constant (en particules par
+   seconde), depuis un point, un disque ou un segment, avec une vitesse
+   dispersée autour de sa moyenne. Ses paramètres viennent en général
+   d'un fichier de scène.
+*/
+typedef struct SEmetteur {
+    FormeEmetteur forme;
+    double x[DIM];  //< position, centre du disque ou première extrémité du segment
+    double x2[DIM]; //< seconde extrémité du segment (EMET_LIGNE)
+    double r;       //< rayon du disque (EMET_DISQUE)
+    double debit;   //< nombre de particules émises par seconde
+    double v[DIM];  //< vitesse moyenne des particules émises
+    LoiAlea loi_v;  //< loi de dispersion de la vitesse
+    double dv;      //< dispersion de la vitesse
+    double m;       //< masse moyenne des particules émises
+    double dm;      //< la masse varie uniformément dans [m-dm,m+dm]
+    double reste;   //< fraction de particule pas encore émise
+    Alea alea;      //< flux aléatoire propre à l'émetteur
+} Emetteur;
+
+/**
+   Initialise un émetteur ponctuel en (x,y), de débit \a debit, qui émet
+   des particules de vitesse (vx,vy) et de masse \a m, sans dispersion.
+   On précise ensuite la forme et les dispersions en modifiant les
+   champs de la structure.
+
+   @param graine la graine du générateur aléatoire de l'émetteur.
+   @param flux le numéro de flux: deux émetteurs d'une même graine
+   doivent avoir des flux différents.
+*/
+void initEmetteur(Emetteur *e, double x, double y, double debit,
+                  double vx, double vy, double m, uint64_t graine, int flux);
+
+/**
+   Fait émettre à l'émetteur \a e toutes les particules correspondant à
+   une durée \a dt. Elles sont créées d'un coup à la fin du tableau \a P
+   et leurs paramètres sont tirés par lots.
+
+   @return le nombre de particules créées.
+*/
+int Emetteur_emet(Emetteur *e, TabParticules *P, double dt);
+
+
+/// Représente un tableau dynamique d'émetteurs.
+typedef struct STabEmetteurs {
+    int taille;
+    int nb;
+    Emetteur *emetteurs;
+} TabEmetteurs;
+
+void TabEmetteurs_init(TabEmetteurs *tab);
+
+void TabEmetteurs_ajoute(TabEmetteurs *tab, Emetteur e);
+
+Emetteur *TabEmetteurs_ref(TabEmetteurs *tab, int i);
+
+int TabEmetteurs_nb(TabEmetteurs *tab);
+
+void TabEmetteurs_termine(TabEmetteurs *tab);
+
+void TabEmetteurs_agrandir(TabEmetteurs *tab);
+
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "ensemble.h"
+#include "tableau.h"
+
+// Ajoute au plan la série décrite par les paramètres.
+static void ajouteSerie(Plan *P, const char *scene, double att, double debit, int repetitions) {
+    if (P->nb == P->taille)
+        P->lignes = Tableau_agrandir(P->lignes, &P->taille, P->nb, sizeof(LignePlan));
+    LignePlan *l = P->lignes + P->nb++;
+    strcpy(l->scene, scene);
+    l->att = att;
+    l->debit = debit;
+    l->repetitions = repetitions;
+    l->premier = P->nb_mondes;
+    P->nb_mondes += repetitions;
+}
+
+// Analyse une ligne "monde ..." (sans le mot-clé). Retourne 0 si elle est mal formée.
+static int lisMonde(const char *s, Plan *P) {
+    char scene[256];
+    double att, debit;
+    int repetitions = 1;
+    int n = sscanf(s, "%255s %lf %lf %d", scene, &att, &debit, &repetitions);
+    if (n < 3 || debit < 0.0 || repetitions < 1)
+        return 0;
+    ajouteSerie(P, scene, att, debit, repetitions);
+    return 1;
+}
+
+// Analyse une ligne "balayage ..." (sans le mot-clé). Retourne 0 si elle est mal formée.
+static int lisBalayage(const char *s, Plan *P) {
+    char scene[256];
+    double att_min, att_max, debit;
+    int nb, repetitions = 1;
+    int n = sscanf(s, "%255s %lf %lf %d %lf %d", scene, &att_min, &att_max, &nb, &debit, &repetitions);
+    if (n < 5 || nb < 1 || debit < 0.0 || repetitions < 1)
+        return 0;
+    for (int k = 0; k < nb; ++k) {
+        double att = nb == 1 ? att_min : att_min + (att_max - att_min) * k / (nb - 1);
+        ajouteSerie(P, scene, att, debit, repetitions);
+    }
+    return 1;
+}
+
+int Plan_charge(const char *nom, Plan *P) {
+    P->taille = 0;
+    P->nb = 0;
+    P->lignes = NULL;
+    P->nb_mondes = 0;
+    FILE *f = fopen(nom, "r");
+    if (f == NULL) {
+        perror(nom);
+        return -1;
+    }
+    char ligne[1024];
+    char mot[32];
+    int num = 0;
+    int erreurs = 0;
+    while (fgets(ligne, sizeof(ligne), f) != NULL) {
+        ++num;
+        char *diese = strchr(ligne, '#');
+        if (diese != NULL) *diese = '\0';
+        int n;
+        if (sscanf(ligne, "%31s%n", mot, &n) != 1)
+            continue; // ligne vide
+        int ok = 0;
+        if (strcmp(mot, "monde") == 0)
+            ok = lisMonde(ligne + n, P);
+        else if (strcmp(mot, "balayage") == 0)
+            ok = lisBalayage(ligne + n, P);
+        if (!ok) {
+            fprintf(stderr, "%s:%d: ligne ignorée\n", nom, num);
+            ++erreurs;
+        }
+    }
+    fclose(f);
+    return erreurs;
+}
+
+void Plan_termine(Plan *P) {
+    Tableau_libere(P->lignes, &P->taille, sizeof(LignePlan));
+    P->lignes = NULL;
+    P->nb = 0;
+    P->nb_mondes = 0;
+}
+
+// Nombre de grandeurs résumées pour chaque série.
+#define NB_GRANDEURS 5
+
+// Les grandeurs de la statistique s, dans l'ordre des colonnes.
+static void grandeurs(const StatsMonde *s, double g[NB_GRANDEURS]) {
+    g[0] = s->particules;
+    g[1] = s->dormantes;
+    g[2] = s->vitesse;
+    g[3] = s->energie;
+    g[4] = s->us_par_pas;
+}
+
+int Ensemble_ecrit(const char *nom, const Plan *P, int nb_pas, const StatsMonde *S) {
+    FILE *f = fopen(nom, "w");
+    if (f == NULL) {
+        perror(nom);
+        return -1;
+    }
+    fprintf(f, "# %d mondes, %d pas de temps\n", P->nb_mondes, nb_pas);
+    fprintf(f, "# monde numero serie scene att debit particules dormantes vitesse energie us_par_pas\n");
+    for (int l = 0; l < P->nb; ++l) {
+        const LignePlan *L = P->lignes + l;
+        for (int k = L->premier; k < L->premier + L->repetitions; ++k)
+            fprintf(f, "monde %d %d %s %g %g %d %d %g %g %.1f\n", k, l, L->scene, L->att, L->debit,
+                    S[k].particules, S[k].dormantes, S[k].vitesse, S[k].energie, S[k].us_par_pas);
+    }
+    // Moyenne et écart-type (non biaisé) de chaque grandeur sur les mondes de la série.
+    fprintf(f, "# serie numero scene att debit repetitions, puis moyenne et ecart-type de:"
+               " particules dormantes vitesse energie us_par_pas\n");
+    for (int l = 0; l < P->nb; ++l) {
+        const LignePlan *L = P->lignes + l;
+        double somme[NB_GRANDEURS] = {0}, somme2[NB_GRANDEURS] = {0};
+        for (int k = L->premier; k < L->premier + L->repetitions; ++k) {
+            double g[NB_GRANDEURS];
+            grandeurs(S + k, g);
+            for (int j = 0; j < NB_GRANDEURS; ++j) {
+                somme[j] += g[j];
+                somme2[j] += g[j] * g[j];
+            }
+        }
+        int n = L->repetitions;
+        fprintf(f, "serie %d %s %g %g %d", l, L->scene, L->att, L->debit, n);
+        for (int j = 0; j < NB_GRANDEURS; ++j) {
+            double moy = somme[j] / n;
+            double var = n > 1 ? (somme2[j] - n * moy * moy) / (n - 1) : 0.0;
+            fprintf(f, " %g %g", moy, sqrt(var > 0.0 ? var : 0.0));
+        }
+        fprintf(f, "\n");
+    }
+    int ok = ferror(f) == 0;
+    return fclose(f) == 0 && ok ? 0 : -1;
+}
@@ -0,0 +1,68 @@
+#ifndef _ENSEMBLE_H_
+#define _ENSEMBLE_H_
+
+/**
+   Une ligne du plan d'expériences: une série de mondes indépendants,
+   identiques aux flux aléatoires près.
+*/
+typedef struct SLignePlan {
+    char scene[256];   //< le fichier de scène, ou "-" pour les émetteurs par défaut
+    double att;        //< atténuation imposée à tous les obstacles (< 0: celle de la scène)
+    double debit;      //< facteur appliqué au débit de tous les émetteurs
+    int repetitions;   //< nombre de mondes de la série
+    int premier;       //< numéro du premier monde de la série
+} LignePlan;
+
+/// Un plan d'expériences: les séries de mondes à simuler ensemble.
+typedef struct SPlan {
+    int taille;
+    int nb;
+    LignePlan *lignes;
+    int nb_mondes;     //< nombre total de mondes (somme des répétitions)
+} Plan;
+
+/**
+   Charge le plan d'expériences \a nom dans \a P (initialisé par cette
+   fonction). Le fichier est un fichier texte, avec une directive par
+   ligne; les lignes vides et ce qui suit un '#' sont ignorés.
+
+   Directives reconnues:
+   - `monde scene att debit [repetitions]` : une série de \a repetitions
+     mondes (1 par défaut) sur le fichier de scène \a scene (`-` pour
+     les fontaines par défaut), où tous les obstacles ont l'atténuation
+     \a att (négative: celle de la scène) et tous les émetteurs leur
+     débit multiplié par \a debit.
+   - `balayage scene att_min att_max n debit [repetitions]` : n séries
+     comme ci-dessus, d'atténuations régulièrement espacées de \a att_min
+     à \a att_max.
+
+   Les mondes sont numérotés dans l'ordre du fichier. Les lignes mal
+   formées sont signalées sur la sortie d'erreur et ignorées.
+
+   @return le nombre de lignes mal formées, ou -1 si le fichier n'a pas pu être ouvert.
+*/
+int Plan_charge(const char *nom, Plan *P);
+
+/// Libère la mémoire du plan.
+void Plan_termine(Plan *P);
+
+/// Les statistiques d'un monde à la fin de sa simulation.
+typedef struct SStatsMonde {
+    int particules;     //< nombre de particules
+    int dormantes;      //< nombre de particules endormies
+    double vitesse;     //< vitesse moyenne des particules
+    double energie;     //< énergie cinétique totale
+    double us_par_pas;  //< durée moyenne d'un pas de temps, en µs
+} StatsMonde;
+
+/**
+   Écrit dans le fichier \a nom les statistiques \a S des mondes du plan
+   \a P après \a nb_pas pas de temps: une ligne `monde` par monde, puis
+   une ligne `serie` par ligne du plan avec la moyenne et l'écart-type de
+   chaque grandeur sur les mondes de la série.
+
+   @return 0, ou -1 si le fichier n'a pas pu être écrit.
+*/
+int Ensemble_ecrit(const char *nom, const Plan *P, int nb_pas, const StatsMonde *S);
+
+#endif
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "histogramme.h"
+
+// Nombre minimal de particules d'un bloc traité par un fil.
+#define HISTO_BLOC 4096
+
+void Histogramme_init(Histogramme *H, const double bmin[DIM], const double bmax[DIM], int nx, int ny,
+                      const Ordonnanceur *O) {
+    assert(nx > 0 && ny > 0);
+    H->nx = nx;
+    H->ny = ny;
+    for (int a = 0; a < 2; ++a) {
+        H->bmin[a] = bmin[a];
+        H->bmax[a] = bmax[a];
+    }
+    H->nb_fils = Ordonnanceur_nbFils(O);
+    H->partiels = (CelluleHisto *) calloc((size_t) H->nb_fils * nx * ny, sizeof(CelluleHisto));
+    H->total = (CelluleHisto *) calloc((size_t) nx * ny, sizeof(CelluleHisto));
+    H->nb_pas = 0;
+}
+
+/// Ce que partagent les blocs de particules de Histogramme_accumule.
+typedef struct SAccumulation {
+    Histogramme *H;
+    TabParticules *P;
+} Accumulation;
+
+// Ajoute les particules [debut,fin[ à la grille partielle du fil courant.
+static void accumuleBloc(void *arg, int debut, int fin) {
+    Accumulation *A = (Accumulation *) arg;
+    Histogramme *H = A->H;
+    int f = Ordonnanceur_numero();
+    assert(f < H->nb_fils);
+    CelluleHisto *G = H->partiels + (size_t) f * H->nx * H->ny;
+    double sx = H->nx / (H->bmax[0] - H->bmin[0]);
+    double sy = H->ny / (H->bmax[1] - H->bmin[1]);
+    for (int i = debut; i < fin; ++i) {
+        const Particule *p = TabParticules_ref(A->P, i);
+        int cx = (int) floor((p->x[0] - H->bmin[0]) * sx);
+        int cy = (int) floor((p->x[1] - H->bmin[1]) * sy);
+        cx = cx < 0 ? 0 : cx >= H->nx ? H->nx - 1 : cx;
+        cy = cy < 0 ? 0 : cy >= H->ny ? H->ny - 1 : cy;
+        CelluleHisto *c = G + cy * H->nx + cx;
+        double v2 = 0.0;
+        for (int k = 0; k < DIM; ++k) {
+            c->v[k] += p->v[k];
+            v2 += p->v[k] * p->v[k];
+        }
+        c->nb += 1.0;
+        c->energie += 0.5 * p->m * v2;
+    }
+}
+
+void Histogramme_accumule(Histogramme *H, TabParticules *P, Ordonnanceur *O) {
+    Accumulation A = {H, P};
+    Ordonnanceur_parallele(O, TabParticules_nb(P), HISTO_BLOC, accumuleBloc, &A);
+    ++H->nb_pas;
+}
+
+// Additionne les grilles partielles dans H->total, et les remet à zéro.
+static void fusionne(Histogramme *H) {
+    size_t n = (size_t) H->nx * H->ny;
+    memset(H->total, 0, n * sizeof(CelluleHisto));
+    for (int f = 0; f < H->nb_fils; ++f) {
+        const CelluleHisto *G = H->partiels + f * n;
+        for (size_t c = 0; c < n; ++c) {
+            H->total[c].nb += G[c].nb;
+            for (int k = 0; k < DIM; ++k)
+                H->total[c].v[k] += G[c].v[k];
+            H->total[c].energie += G[c].energie;
+        }
+    }
+    memset(H->partiels, 0, H->nb_fils * n * sizeof(CelluleHisto));
+}
+
+int Histogramme_ecrit(Histogramme *H, const char *nom, FormatHisto format) {
+    fusionne(H);
+    int nb_pas = H->nb_pas > 0 ? H->nb_pas : 1;
+    H->nb_pas = 0;
+    FILE *f = fopen(nom, format == HISTO_BINAIRE ? "wb" : "w");
+    if (f == NULL) {
+        perror(nom);
+        return -1;
+    }
+    double lx = (H->bmax[0] - H->bmin[0]) / H->nx;
+    double ly = (H->bmax[1] - H->bmin[1]) / H->ny;
+    // Les sommes deviennent des moyennes par pas et par unité d'aire.
+    double par_aire = 1.0 / (nb_pas * lx * ly);
+    if (format == HISTO_BINAIRE) {
+        int entete[4] = {H->nx, H->ny, DIM, nb_pas};
+        double boite[4] = {H->bmin[0], H->bmin[1], H->bmax[0], H->bmax[1]};
+        fwrite("HISTO", 1, 6, f);
+        fwrite(entete, sizeof(int), 4, f);
+        fwrite(boite, sizeof(double), 4, f);
+    } else
+        fprintf(f, DIM == 3 ? "i,j,x,y,densite,vx,vy,vz,energie\n" : "i,j,x,y,densite,vx,vy,energie\n");
+    for (int j = 0; j < H->ny; ++j)
+        for (int i = 0; i < H->nx; ++i) {
+            const CelluleHisto *c = H->total + j * H->nx + i;
+            double valeurs[2 + DIM];
+            valeurs[0] = c->nb * par_aire;
+            for (int k = 0; k < DIM; ++k)
+                valeurs[1 + k] = c->nb > 0.0 ? c->v[k] / c->nb : 0.0;
+            valeurs[1 + DIM] = c->energie * par_aire;
+            if (format == HISTO_BINAIRE) {
+                fwrite(valeurs, sizeof(double), 2 + DIM, f);
+                continue;
+            }
+            fprintf(f, "%d,%d,%g,%g", i, j, H->bmin[0] + (i + 0.5) * lx, H->bmin[1] + (j + 0.5) * ly);
+            for (int k = 0; k < 2 + DIM; ++k)
+                fprintf(f, ",%g", valeurs[k]);
+            fprintf(f, "\n");
+        }
+    int ok = ferror(f) == 0;
+    return fclose(f) == 0 && ok ? 0 : -1;
+}
+
+void Histogramme_termine(Histogramme *H) {
+    free(H->partiels);
+    free(H->total);
+    H->partiels = NULL;
+    H->total = NULL;
+    H->nb_fils = 0;
+}
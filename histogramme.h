@@ -0,0 +1,80 @@
+#ifndef _HISTOGRAMME_H_
+#define _HISTOGRAMME_H_
+
+#include "points.h"
+#include "particules.h"
+#include "ordonnanceur.h"
+
+/// Ce qu'accumule une cellule de la grille, sommé sur les particules et les pas de temps.
+typedef struct SCelluleHisto {
+    double nb;          //< nombre de particules
+    double v[DIM];      //< somme de leurs vitesses
+    double energie;     //< somme de leurs énergies cinétiques
+} CelluleHisto;
+
+/// Format des fichiers écrits par Histogramme_ecrit.
+typedef enum {
+    HISTO_CSV,     //< texte, une ligne par cellule
+    HISTO_BINAIRE  //< un en-tête puis les cellules, en double natifs
+} FormatHisto;
+
+/**
+   Un histogramme de la densité, de la vitesse moyenne et de l'énergie
+   cinétique des particules sur une grille régulière de nx*ny cellules
+   du rectangle [bmin,bmax] (projection sur le plan xy en 3D). Il
+   remplace l'écriture des particules elles-mêmes: seules les grilles
+   sont écrites, moyennées sur une période de plusieurs pas.
+
+   Chaque fil de calcul accumule dans sa propre grille partielle: il
+   n'y a ni verrou ni opération atomique pendant l'accumulation, et les
+   grilles partielles ne sont additionnées qu'au moment d'écrire.
+*/
+typedef struct SHistogramme {
+    int nx, ny;               //< nombre de cellules en x et en y
+    double bmin[2], bmax[2];  //< le rectangle couvert
+    int nb_fils;              //< nombre de grilles partielles
+    CelluleHisto *partiels;   //< nb_fils grilles de nx*ny cellules, la cellule (i,j) en j*nx+i
+    CelluleHisto *total;      //< la somme des grilles partielles, calculée par Histogramme_ecrit
+    int nb_pas;               //< nombre de pas accumulés depuis la dernière écriture
+} Histogramme;
+
+/**
+   Initialise un histogramme vide de \a nx * \a ny cellules sur le
+   rectangle [bmin,bmax] (seuls les deux premiers axes comptent), avec
+   une grille partielle pour chacun des fils de \a O.
+*/
+void Histogramme_init(Histogramme *H, const double bmin[DIM], const double bmax[DIM], int nx, int ny,
+                      const Ordonnanceur *O);
+
+/**
+   Ajoute à l'histogramme les particules de \a P (dormantes comprises)
+   pour un pas de temps. Les particules sont réparties entre les fils de
+   \a O par blocs, chacun dans sa grille partielle. Les particules hors
+   du rectangle comptent dans la cellule du bord la plus proche.
+*/
+void Histogramme_accumule(Histogramme *H, TabParticules *P, Ordonnanceur *O);
+
+/**
+   Écrit dans le fichier \a nom l'histogramme moyenné sur les pas
+   accumulés depuis la dernière écriture, puis le remet à zéro. Pour
+   chaque cellule:
+   - la densité: nombre moyen de particules par unité d'aire;
+   - la vitesse moyenne des particules de la cellule (nulle si elle est vide);
+   - l'énergie cinétique moyenne par unité d'aire.
+
+   En CSV, la première ligne nomme les colonnes: i, j, le centre x y de
+   la cellule, densite, vx, vy (vz en 3D), energie. En binaire, le
+   fichier commence par l'en-tête "HISTO" (6 octets avec le '\0'),
+   suivi de quatre int (nx, ny, DIM, nombre de pas moyennés), de quatre
+   double (bmin[0], bmin[1], bmax[0], bmax[1]), puis, cellule par
+   cellule dans l'ordre j*nx+i, de 2+DIM double (densité, vitesse,
+   énergie).
+
+   @return 0, ou -1 si le fichier n'a pas pu être écrit.
+*/
+int Histogramme_ecrit(Histogramme *H, const char *nom, FormatHisto format);
+
+/// Libère la mémoire de l'histogramme.
+void Histogramme_termine(Histogramme *H);
+
+#endif
@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <math.h>
+#include "indexobstacles.h"
+#include "tableau.h"
+
+// On reconstruit quand les noeuds inutiles ou insérés dépassent la
+// moitié des obstacles (plus une marge pour les petites scènes).
+static int doitReconstruire(IndexObstacles *I) {
+    return I->nb_morts + I->nb_inseres > TabObstacles_nb(I->O) / 2 + 64;
+}
+
+// Distance maximale entre le centre de l'obstacle o et l'un de ses points.
+static double portee(const Obstacle *o) {
+    double d2 = 0.0;
+    for (int k = 0; k < DIM; ++k)
+        d2 += (o->x2[k] - o->x[k]) * (o->x2[k] - o->x[k]);
+    return sqrt(d2) + o->r;
+}
+
+// Garantit que noeud_de peut recevoir tous les obstacles du tableau.
+static void reserveNoeuds(IndexObstacles *I) {
+    int n = TabObstacles_nb(I->O);
+    if (n > I->taille)
+        I->noeud_de = Tableau_reserve(I->noeud_de, &I->taille, I->taille,
+                                      n > 2 * I->taille ? n : 2 * I->taille, sizeof(Noeud *));
+}
+
+void IndexObstacles_init(IndexObstacles *I, TabObstacles *O) {
+    I->O = O;
+    Arene_init(&I->arene);
+    I->kdtree = ArbreVide();
+    I->noeud_de = NULL;
+    I->taille = 0;
+    I->version = 0;
+    IndexObstacles_reconstruit(I);
+}
+
+void IndexObstacles_reconstruit(IndexObstacles *I) {
+    int n = TabObstacles_nb(I->O);
+    I->kdtree = KDT_ConstruitObstacles(&I->arene, I->O->obstacles, n);
+    reserveNoeuds(I);
+    I->r_max = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double r = portee(TabObstacles_ref(I->O, i));
+        I->r_max = r > I->r_max ? r : I->r_max;
+    }
+    // Juste après la construction, tous les noeuds sont dans le bloc principal.
+    for (int k = 0; k < I->arene.nb; ++k) {
+        Noeud *N = I->arene.noeuds + k;
+        I->noeud_de[N->indice] = N;
+    }
+    I->nb_morts = 0;
+    I->nb_inseres = 0;
+    ++I->version;
+}
+
+// Insère l'obstacle i (déjà dans le tableau) dans l'arbre, ou reconstruit
+// tout l'arbre s'il est devenu trop déséquilibré.
+static void insere(IndexObstacles *I, int i) {
+    double r = portee(TabObstacles_ref(I->O, i));
+    I->r_max = r > I->r_max ? r : I->r_max;
+    ++I->nb_inseres;
+    if (doitReconstruire(I))
+        IndexObstacles_reconstruit(I);
+    else {
+        reserveNoeuds(I);
+        I->noeud_de[i] = KDT_InsereObstacles(&I->arene, &I->kdtree, I->O->obstacles, i);
+        ++I->version;
+    }
+}
+
+int IndexObstacles_ajoute(IndexObstacles *I, Obstacle o) {
+    TabObstacles_ajoute(I->O, o);
+    int i = TabObstacles_nb(I->O) - 1;
+    insere(I, i);
+    return i;
+}
+
+void IndexObstacles_supprime(IndexObstacles *I, int i) {
+    int dernier = TabObstacles_nb(I->O) - 1;
+    assert(i >= 0 && i <= dernier);
+    I->noeud_de[i]->supprime = 1;
+    ++I->nb_morts;
+    TabObstacles_supprime(I->O, i);
+    if (i != dernier) {
+        I->noeud_de[i] = I->noeud_de[dernier];
+        I->noeud_de[i]->indice = i;
+    }
+    ++I->version;
+    if (doitReconstruire(I))
+        IndexObstacles_reconstruit(I);
+}
+
+void IndexObstacles_deplace(IndexObstacles *I, int i, Point p) {
+    Obstacle *o = TabObstacles_ref(I->O, i);
+    // Un obstacle étendu est translaté en entier.
+    for (int k = 0; k < DIM; ++k) {
+        o->x2[k] += p.x[k] - o->x[k];
+        o->x[k] = p.x[k];
+    }
+    I->noeud_de[i]->supprime = 1;
+    ++I->nb_morts;
+    insere(I, i);
+}
+
+void IndexObstacles_modifie(IndexObstacles *I, int i, double r, double att) {
+    Obstacle *o = TabObstacles_ref(I->O, i);
+    o->r = r;
+    o->att = att;
+    I->r_max = portee(o) > I->r_max ? portee(o) : I->r_max;
+    // La position ne change pas: la clé du noeud reste valable.
+}
+
+int IndexObstacles_plusProche(IndexObstacles *I, const Point *p, double *d) {
+    Noeud *N = KDT_PlusProche(Racine(I->kdtree), p, d);
+    return N == NULL ? -1 : N->indice;
+}
+
+void IndexObstacles_termine(IndexObstacles *I) {
+    Arene_termine(&I->arene);
+    Tableau_libere(I->noeud_de, &I->taille, sizeof(Noeud *));
+    I->noeud_de = NULL;
+    I->kdtree = ArbreVide();
+}
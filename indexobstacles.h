@@ -0,0 +1,89 @@
+#ifndef _INDEXOBSTACLES_H_
+#define _INDEXOBSTACLES_H_
+
+#include "obstacles.h"
+#include "arbre.h"
+
+/**
+   Un index spatial modifiable sur un tableau d'obstacles: l'arbre k-D
+   des obstacles, maintenu paresseusement quand on ajoute, supprime,
+   déplace ou modifie un obstacle.
+
+   - un ajout insère une feuille dans l'arbre (KDT_Insere);
+   - une suppression transforme le noeud en pierre tombale, qui guide
+     encore la recherche mais n'est plus jamais retournée;
+   - un déplacement est une suppression suivie d'une insertion;
+   - un changement de rayon ou d'atténuation ne touche pas l'arbre, qui
+     ne retient que la position et l'indice de chaque obstacle.
+
+   Chaque opération coûte donc O(profondeur). Quand les pierres tombales
+   et les insertions représentent trop de noeuds par rapport aux
+   obstacles, l'arbre est reconstruit d'un coup et redevient équilibré.
+
+   Les indices des obstacles dans le tableau ne changent qu'à la
+   suppression: le dernier obstacle prend la place de l'obstacle
+   supprimé.
+
+   L'arbre ne connaît que le centre (le premier point) de chaque
+   obstacle: une recherche des obstacles à moins de \a r d'un point doit
+   donc chercher les centres à moins de \a r + r_max. r_max ne diminue
+   qu'à la reconstruction.
+*/
+typedef struct SIndexObstacles {
+    TabObstacles *O;   //< le tableau d'obstacles indexé (il n'appartient pas à l'index)
+    Arene arene;       //< les noeuds de l'arbre
+    Arbre *kdtree;     //< la racine de l'arbre
+    Noeud **noeud_de;  //< noeud_de[i] est le noeud vivant de l'obstacle i
+    int taille;        //< capacité de noeud_de
+    int nb_morts;      //< nombre de pierres tombales dans l'arbre
+    int nb_inseres;    //< nombre de noeuds insérés depuis la dernière reconstruction
+    int version;       //< change à chaque modification de l'arbre
+    double r_max;      //< plus grande distance entre la clé d'un obstacle et un point de cet obstacle
+} IndexObstacles;
+
+/**
+   Initialise l'index \a I sur le tableau d'obstacles \a O et construit
+   son arbre.
+*/
+void IndexObstacles_init(IndexObstacles *I, TabObstacles *O);
+
+/**
+   Reconstruit entièrement l'arbre à partir du tableau d'obstacles. À
+   appeler après avoir modifié le tableau sans passer par l'index
+   (chargement d'une scène par exemple).
+*/
+void IndexObstacles_reconstruit(IndexObstacles *I);
+
+/**
+   Ajoute l'obstacle \a o à la fin du tableau et dans l'arbre.
+
+   @return l'indice de l'obstacle dans le tableau.
+*/
+int IndexObstacles_ajoute(IndexObstacles *I, Obstacle o);
+
+/**
+   Supprime l'obstacle d'indice \a i. Le dernier obstacle du tableau
+   prend l'indice \a i.
+*/
+void IndexObstacles_supprime(IndexObstacles *I, int i);
+
+/**
+   Déplace le centre de l'obstacle d'indice \a i en \a p.
+*/
+void IndexObstacles_deplace(IndexObstacles *I, int i, Point p);
+
+/**
+   Change le rayon \a r et l'atténuation \a att de l'obstacle d'indice \a i.
+*/
+void IndexObstacles_modifie(IndexObstacles *I, int i, double r, double att);
+
+/**
+   @return l'indice de l'obstacle le plus proche du point \a p, ou -1
+   s'il n'y a aucun obstacle; sa distance à \a p est mise dans *d.
+*/
+int IndexObstacles_plusProche(IndexObstacles *I, const Point *p, double *d);
+
+/// Libère la mémoire de l'index (mais pas le tableau d'obstacles).
+void IndexObstacles_termine(IndexObstacles *I);
+
+#endif
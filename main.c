@@ -1,38 +1,173 @@
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 #include <gtk/gtk.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include "points.h"
 #include "particules.h"
 #include "forces.h"
 #include "obstacles.h"
 #include "arbre.h"
+#include "alea.h"
+#include "emetteurs.h"
+#include "scene.h"
+#include "morton.h"
+#include "indexobstacles.h"
+#include "mobiles.h"
+#include "collisions.h"
+#include "sdf.h"
+#include "domaine.h"
+#include "profil.h"
+#include "ordonnanceur.h"
+#include "commandes.h"
+#include "trame.h"
+#include "ensemble.h"
+#include "histogramme.h"
+#include "carte.h"
 
 //-----------------------------------------------------------------------------
 // Déclaration des types
 //-----------------------------------------------------------------------------
+/// Les options de l'histogramme des particules (voir \ref Histogramme).
+typedef struct SOptionsHisto {
+    const char *prefixe;  //< début du nom des fichiers, ou NULL pour ne pas calculer d'histogramme
+    int periode;          //< nombre de pas moyennés dans chaque fichier
+    FormatHisto format;
+} OptionsHisto;
+
+/**
+   La partie du plan affichée dans la zone de dessin: le point \a centre
+   est au milieu, et la largeur de la zone couvre 2 / \a zoom unités
+   (zoom 1: [-1,1] sur toute la largeur).
+*/
+typedef struct SVue {
+    double centre[2];
+    double zoom;
+} Vue;
+
 /**
    Le contexte contient les informations utiles de l'interface pour
    les algorithmes de géométrie algorithmique.
+
+   Avec l'interface, la simulation tourne dans son propre fil (\ref
+   boucleSimulation), qui est seul à toucher aux particules et aux
+   obstacles. L'interface lui envoie des commandes (\a commandes) et ne
+   dessine que les trames qu'il publie (\a trames).
+
+   En mode ensemble, chaque monde simulé a son propre contexte (voir
+   \ref copieMonde).
 */
 typedef struct SContexte {
     int width;
     int height;
+    Vue vue;                             //< la partie du plan affichée (interface)
+    double ancre[2];                     //< la dernière position de la souris qui déplace la vue, en pixels
     GtkWidget *drawing_area;
     TabParticules TabP;
     TabObstacles TabO;
-    Arbre *kdtree;
+    TabEmetteurs TabE;
+    IndexObstacles index;                //< l'arbre k-D de TabO, modifiable
+    Mobiles mobiles;                     //< les obstacles en mouvement
+    TabObstacles murs;                   //< les segments, capsules et boîtes (fixes)
+    BVH bvh_murs;                        //< hiérarchie des boîtes englobantes des murs
+    SDF sdf;                             //< champ de distance précalculé des obstacles de TabO
+    Domaine domaine;                     //< le rectangle simulé et ses bords
+    TriMorton tri;                       //< ordre de traitement des particules
+    int pas;                             //< nombre de pas de temps effectués
+    int selection;                       //< indice de l'obstacle sélectionné, ou -1
+    bool glisse;                         //< vrai si on déplace la sélection à la souris
+    Ordonnanceur *ordonnanceur;          //< les fils de calcul (communs à tous les mondes d'un ensemble)
+    TabObstacles *candidats;             //< pour chaque fil, obstacles proches de chaque particule d'un paquet
+    int64_t *temps_fils;                 //< pour chaque fil, temps passé dans chaque phase de deplaceTout
     Force forces[NB_FORCES];
+    Force forces_avant[NB_FORCES];       //< les forces du pas précédent, pour voir si elles changent
     GtkWidget *label_nb;
     GtkWidget *label_distance;
     GtkWidget *force_obstacle;
+    GtkWidget *bouton_sdf;               //< active les collisions par le champ de distance
+    GtkWidget *label_profil;             //< min/moy/p99 de chaque phase du pas de temps
+    GtkWidget *bouton_carte;             //< affiche la carte de densité au lieu des particules
+    Carte carte;                         //< la carte de densité et de vitesse des particules
+    GtkWidget *bouton_arbre;             //< affiche l'arbre k-D des obstacles
+    cairo_surface_t *image_arbre;        //< l'arbre k-D dessiné, gardé tant qu'il ne change pas
+    int version_image_arbre;             //< la version de l'arbre dessiné dans image_arbre, ou -1
+    Vue vue_image_arbre;                 //< la vue dans laquelle il a été dessiné
+    bool sdf_actif;                      //< vrai si les collisions passent par le champ de distance
+    Profil profil;                       //< temps passé dans chaque phase du pas de temps
+    char resume[TRAME_TEXTE];            //< dernier résumé de \a profil, recopié dans les trames
+    Alea alea;
+    FileCommandes commandes;             //< de l'interface vers le fil de simulation
+    EchangeTrames trames;                //< du fil de simulation vers l'interface
+    pthread_t fil_simulation;
+    int arret;                           //< demande l'arrêt du fil de simulation (accès atomiques)
+    Profil profil_affichage;             //< temps passé à dessiner, mesuré par l'interface
+    Histogramme *histo;                  //< densité, vitesses et énergie accumulées, ou NULL
+    const OptionsHisto *options_histo;
+    char nom_histo[256];                 //< début du nom des fichiers de l'histogramme de ce monde
 } Contexte;
 
+/// Ce que partagent les blocs de paquets traités en parallèle par deplaceTout.
+typedef struct SDeplacement {
+    Contexte *pCtxt;
+    const int *ordre;   //< les particules actives dans l'ordre de Morton (relatif à d)
+    int d;              //< indice de la première particule active
+    int n;              //< nombre de particules actives
+    const SDF *S;       //< le champ de distance, ou NULL
+} Deplacement;
+
+/// Ce que partagent les tâches de simuleEnsemble.
+typedef struct SEnsemble {
+    Contexte *mondes;
+    StatsMonde *stats;  //< les statistiques de chaque monde à la fin
+    int nb_pas;
+} Ensemble;
+
 // Pas de temps en s
 #define DT 0.005
 // Pas de temps en s pour le réaffichage
 #define DT_AFF 0.02
+// Nombre de pas de temps entre deux trames publiées pour l'affichage
+#define PAS_PAR_TRAME ((int) (DT_AFF / DT + 0.5))
+// Nombre de pas de temps entre deux résumés du profileur (1 s)
+#define PAS_RESUME 200
+// Rayon de recherche des obstacles autour d'une particule. L'arbre k-D
+// ne retient que le centre des obstacles: il est interrogé à
+// RAYON_CANDIDATS + index.r_max.
+#define RAYON_CANDIDATS 0.05
+// Nombre de pas de temps entre deux réordonnancements des particules
+// en mémoire selon l'ordre de Morton (0 pour ne jamais réordonner)
+#define REORDONNE_TOUS 16
+// Une particule plus lente que VITESSE_SOMMEIL pendant PAS_SOMMEIL pas
+// de temps consécutifs s'endort: elle n'est plus simulée jusqu'à son réveil.
+#define VITESSE_SOMMEIL 0.01
+#define PAS_SOMMEIL 50
+// Nombre de cellules de l'histogramme sur chaque axe du domaine
+#define HISTO_CELLULES 64
+// Nombre de pas de temps moyennés par défaut dans un fichier d'histogramme
+#define HISTO_PERIODE 200
+// Nombre de pas de temps simulés par défaut en mode ensemble
+#define PAS_ENSEMBLE 1000
+// Au-delà de ce nombre de particules, on affiche toujours la carte de densité
+#define CARTE_SEUIL 100000
+// Vitesse à laquelle la couleur d'une particule sature
+#define VITESSE_MAX_AFF 1.5
+// Taille en pixels au-dessous de laquelle une cellule de l'arbre k-D n'est plus détaillée
+#define ARBRE_SEUIL_PIXELS 3.0
+// Rayon en pixels du dessin d'un obstacle fixe: marge de la vue pour ne pas couper ce qui dépasse du bord
+#define RAYON_OBSTACLE_AFF 10.0
+// Facteur de zoom d'un cran de la molette, et zooms extrêmes
+#define ZOOM_PAS 1.25
+#define ZOOM_MIN 0.1
+#define ZOOM_MAX 1e4
+// Pas de la grille du champ de distance des obstacles. Le champ n'existe
+// qu'en 2D: en 3D, ce pas donnerait une grille de 601^3 noeuds.
+#define SDF_PAS 0.005
+// Nombre de paquets de particules d'un bloc traité par un fil dans deplaceTout
+#define PAQUETS_PAR_BLOC 8
+// Graine du générateur aléatoire (la même graine redonne la même simulation)
+#define GRAINE 2020
 
 
 //-----------------------------------------------------------------------------
@@ -50,11 +185,23 @@ gboolean realize_evt_reaction(GtkWidget *widget, gpointer data);
 
 /**
    C'est la réaction principale qui est appelée pour redessiner la zone de dessin.
+   Les particules sont dessinées une à une, ou par la carte de densité
+   (\ref drawCarte) si elle est demandée ou s'il y en a plus de CARTE_SEUIL.
+   Seul ce qui est visible est parcouru: les particules des cellules de
+   la grille de la trame qui touchent la vue, et les obstacles trouvés
+   par l'arbre k-D (\ref drawObstacles).
 */
 gboolean expose_evt_reaction(GtkWidget *widget, GdkEventExpose *event, gpointer data);
 
 /**
-   Fait la conversion coordonnées réelles de \a p vers coordonnées de la zone de dessin.
+   Met dans [bmin,bmax] le rectangle du plan visible dans la zone de
+   dessin, élargi de \a marge pixels de chaque côté.
+*/
+void rectangleVisible(Contexte *pCtxt, double marge, double bmin[2], double bmax[2]);
+
+/**
+   Fait la conversion coordonnées réelles de \a p vers coordonnées de la zone de dessin,
+   selon la vue courante.
    @param pCtxt le contexte de l'IHM
    @param p le point en entrée
    @return ses coordonnées dans la zone de dessin.
@@ -84,24 +231,205 @@ Point drawingAreaPoint2Point(Contexte *pCtxt, Point p);
    @param cr le contexte CAIRO pour dessiner dans une zone de dessin.
    @param p un point dans la zone de dessin.
  */
-void drawParticule(Contexte *pCtxt, cairo_t *cr, Particule p);
+void drawParticule(Contexte *pCtxt, cairo_t *cr, const ParticuleTrame *p);
+
+/**
+   Affiche les particules de la trame \a T par la carte de densité et
+   de vitesse (\ref Carte), copiée d'un bloc dans la zone de dessin.
+   Seules les particules des cellules de la grille comprises dans
+   \a plage (voir \ref Trame_plage) y sont ajoutées.
+*/
+void drawCarte(Contexte *pCtxt, cairo_t *cr, const Trame *T, const int plage[4]);
+
+/**
+   Affiche les obstacles fixes de la trame \a T qui sont dans le
+   rectangle [bmin,bmax], cherchés dans le sous-arbre des noeuds \a N
+   de racine N[i] et d'axe \a a: on ne descend que du côté des coupes
+   qui touche le rectangle.
+*/
+void drawObstacles(Contexte *pCtxt, cairo_t *cr, Trame *T, const NoeudTrame *N, int i,
+                   const double bmin[2], const double bmax[2], int a);
 
 /**
    Fonction de base qui affiche un disque de centre (x,y) et de rayon r via cairo.
 */
 void drawPoint(cairo_t *cr, double x, double y, double r);
 
-void viewerKDTree(Contexte *pCtxt, cairo_t *cr, Noeud *N, Point bg, Point hd, int a);
+/**
+   Affiche un obstacle étendu: un segment comme un trait fin, une
+   capsule comme un trait épais aux bouts arrondis, une boîte comme un
+   rectangle plein.
+*/
+void drawMur(Contexte *pCtxt, cairo_t *cr, const Obstacle *o);
+
+/**
+   Affiche l'arbre k-D des obstacles recopié dans la trame \a T: les
+   droites de coupe et les obstacles vivants. L'arbre est dessiné dans
+   une image à part (\a image_arbre), refaite seulement quand sa version
+   ou la vue change, puis copiée d'un bloc sur la zone de dessin.
+*/
+void drawArbre(Contexte *pCtxt, cairo_t *cr, const Trame *T);
+
+/**
+   Ajoute au chemin de \a traits les droites de coupe du sous-arbre des
+   noeuds \a N dont la racine est N[i], d'axe \a a, et au chemin de \a
+   points ses obstacles vivants. [bmin,bmax] est la partie visible de la
+   cellule du noeud (en coordonnées réelles): un sous-arbre dont la
+   cellule visible est vide, ou plus étroite que ARBRE_SEUIL_PIXELS dans
+   une direction, n'est pas parcouru. Le coût dépend donc de la
+   taille de la fenêtre et non du nombre d'obstacles.
+*/
+void traceNoeuds(Contexte *pCtxt, cairo_t *traits, cairo_t *points, const NoeudTrame *N, int i,
+                 Point bmin, Point bmax, int a);
+
+/**
+   Initialise le monde \a pCtxt sur la scène \a scene (ou sur les
+   fontaines par défaut si \a scene est NULL): charge ses obstacles et
+   ses émetteurs, et construit l'arbre k-D et la hiérarchie des murs.
+   Les fils de calcul sont ceux de \a O.
+
+   @param trace vrai si le profileur doit garder tous les pas.
+   @return 0, ou -1 si la scène n'a pas pu être lue (le monde est alors
+   déjà libéré).
+*/
+int initMonde(Contexte *pCtxt, Ordonnanceur *O, const char *scene, bool trace);
+
+/**
+   Initialise le monde numéro \a numero d'un ensemble comme une copie du
+   monde \a decor, qui n'est pas simulé. L'arbre k-D des obstacles et la
+   hiérarchie des murs ne dépendent que des positions: ils sont partagés
+   en lecture seule avec le décor. Le reste est propre au monde: ses
+   particules, ses obstacles mobiles, et ses copies des obstacles, où
+   l'atténuation vaut \a att (si \a att >= 0). Ses émetteurs ont leur
+   débit multiplié par \a debit. Le monde tire dans les flux aléatoires
+   [flux, flux+e+1[ pour e émetteurs: le générateur du monde, puis un
+   par émetteur (le monde de flux 0 reprend ceux d'une simulation seule).
+*/
+void copieMonde(Contexte *pCtxt, Contexte *decor, int flux, double att, double debit);
+
+/**
+   Libère ce qui appartient au monde \a pCtxt (copié par copieMonde):
+   particules, copies des obstacles, obstacles mobiles, émetteurs, champ
+   de distance, tampons des fils et histogramme. L'arbre k-D et la
+   hiérarchie des murs, partagés avec le décor, ne sont pas touchés.
+*/
+void termineMonde(Contexte *pCtxt);
+
+/**
+   Libère tout le monde \a pCtxt (initialisé par initMonde), y compris
+   l'arbre k-D et la hiérarchie des murs. Pour un décor, à n'appeler
+   qu'après avoir terminé tous les mondes qui le partagent.
+*/
+void termineDecor(Contexte *pCtxt);
+
+/**
+   Fait accumuler au monde \a pCtxt l'histogramme de ses particules à
+   chaque pas de temps, selon les options \a opt (rien si \a
+   opt->prefixe est NULL). Tous les opt->periode pas, il est écrit dans
+   le fichier PREFIXE_PAS.csv (ou .bin), où PREFIXE est opt->prefixe,
+   suivi de _mondeN pour le monde \a numero d'un ensemble (\a numero
+   négatif hors ensemble).
+*/
+void activeHistogramme(Contexte *pCtxt, const OptionsHisto *opt, int numero);
+
+/**
+   Écrit l'histogramme du monde \a pCtxt accumulé depuis la dernière
+   écriture, dans le fichier PREFIXE_PAS.csv (ou .bin) du pas courant.
+*/
+void ecritHistogramme(Contexte *pCtxt);
 
 /**
-   Fonction appelée régulièrement (tous les DT secondes) et qui s'occupe de (presque tout):
-   - générer de nouvelles particules: \ref fontaine
+   Fin de simulation: écrit ce qui reste de la dernière période de
+   l'histogramme (s'il y a des pas accumulés depuis la dernière
+   écriture), puis libère l'histogramme.
+*/
+void termineHistogramme(Contexte *pCtxt);
+
+/// Calcule les statistiques de fin de simulation du monde \a pCtxt (sauf sa durée).
+void statsMonde(Contexte *pCtxt, StatsMonde *s);
+
+/**
+   Mode ensemble: simule sans fenêtre, pendant \a nb_pas pas de temps,
+   tous les mondes du plan d'expériences \a nom_plan (voir \ref
+   Plan_charge), et écrit leurs statistiques dans \a sortie. Les mondes
+   d'une même scène partagent son décor. Chaque monde est une tâche de
+   \a O: tous les fils sont occupés même si les mondes sont trop petits
+   pour être partagés, et les gros mondes répartissent en plus leurs
+   paquets de particules entre les fils inoccupés. Chaque monde a son
+   propre histogramme si \a histo le demande.
+
+   @return le code de sortie du programme.
+*/
+int simuleEnsemble(const char *nom_plan, const char *sortie, int nb_pas, Ordonnanceur *O, bool sdf_actif,
+                   const OptionsHisto *histo);
+
+/**
+   Simule entièrement, l'un après l'autre, les mondes [debut,fin[ de
+   l'Ensemble \a arg, et calcule leurs statistiques.
+
+   Un fil qui attend les tâches de son monde peut simuler en attendant
+   tout un autre monde (vol de travail): la durée d'un monde ne compte
+   pas celle des mondes simulés pendant ce temps par son fil.
+*/
+void simuleMondes(void *arg, int debut, int fin);
+
+/**
+   Crée les émetteurs utilisés quand aucun fichier de scène n'est donné:
+   trois jets qui reproduisent les anciennes fontaines codées en dur.
+*/
+void emetteursParDefaut(Contexte *pCtxt);
+
+/**
+   Fait avancer la simulation d'un pas de temps DT:
+   - générer de nouvelles particules: \ref Emetteur_emet
    - calculer les forces sur chaque particule: \ref calculDynamique
    - déplacer les particules et gérer les collisions: \ref deplaceTout
+   - accumuler et écrire l'histogramme, s'il y en a un: \ref Histogramme_accumule
+
+   Chaque phase est mesurée par le profileur du contexte.
+*/
+void pasDeTemps(Contexte *pCtxt);
+
+/**
+   La boucle du fil de simulation: applique les commandes reçues de
+   l'interface, fait un pas de temps (\ref pasDeTemps) tous les DT
+   secondes, et publie une trame tous les PAS_PAR_TRAME pas. Un pas en
+   retard n'est pas rattrapé: la simulation ralentit au lieu de
+   s'emballer. S'arrête quand \a arret devient vrai.
 
    @param data correspond en fait au pointeur vers le Contexte.
 */
-gint tic(gpointer data);
+void *boucleSimulation(void *data);
+
+/**
+   Recopie dans la prochaine trame ce que l'interface doit dessiner, et
+   la publie.
+*/
+void publieTrame(Contexte *pCtxt);
+
+/**
+   Exécute dans le fil de simulation la commande \a c envoyée par
+   l'interface:
+   - CMD_CLIC, bouton gauche sur un obstacle: le sélectionne, et commence à le déplacer;
+   - CMD_CLIC, bouton gauche ailleurs: crée un obstacle;
+   - CMD_CLIC, bouton droit sur un obstacle: le supprime;
+   - CMD_GLISSE: déplace l'obstacle sélectionné;
+   - CMD_LACHE: termine le déplacement;
+   - CMD_SDF: active ou non les collisions par le champ de distance.
+*/
+void appliqueCommande(Contexte *pCtxt, const Commande *c);
+
+/**
+   Envoie la commande \a c au fil de simulation, en attendant qu'il y
+   ait de la place dans la file si elle est pleine.
+*/
+void envoieCommande(Contexte *pCtxt, const Commande *c);
+
+/// Réaction à la case "Champ de distance": prévient le fil de simulation.
+void sdf_toggled_reaction(GtkToggleButton *bouton, gpointer data);
+
+/// Réaction au bouton "Vue initiale": revient à [-1,1]x[-1,1].
+void vue_initiale_reaction(GtkButton *bouton, gpointer data);
 
 /**
    Fonction appelée régulièrement (tous les DT_AFF secondes) et qui
@@ -113,7 +441,8 @@ gint ticAffichage(gpointer data);
 
 /**
    Fonction appelée régulièrement (tous les secondes) et qui
-   affiche le nombre d'appels à la fonction \c distance par seconde.
+   affiche le nombre d'appels à la fonction \c distance par seconde,
+   ainsi que le temps passé dans chaque phase du pas de temps.
 
    @param data correspond en fait au pointeur vers le Contexte.
 */
@@ -126,36 +455,91 @@ gint ticDistance(gpointer data);
 void calculDynamique(Contexte *pCtxt);
 
 /**
-   Déplace toutes les particules en fonction de leur vitesse.
+   Range les particules en mémoire selon l'ordre de Morton de leur
+   position, pour que des particules voisines dans le plan soient
+   voisines en mémoire. Appelée tous les REORDONNE_TOUS pas de temps.
 */
-void deplaceTout(Contexte *pCtxt);
+void reordonneParticules(Contexte *pCtxt);
 
 /**
-   Déplace une particule en fonction de sa vitesse. Devra s'occuper
-   des collisions plus tard.
+   Prévient la simulation que l'obstacle \a o de TabO apparaît,
+   disparaît ou bouge: les tuiles du champ de distance qu'il touche sont
+   à recalculer, et les particules dormantes autour de lui se réveillent.
+   Pour un déplacement, on l'appelle avant et après.
 */
-void deplaceParticule(Contexte *pCtxt, Particule *p);
+void obstacleChange(Contexte *pCtxt, const Obstacle *o);
 
 /**
-  Fontaine pour créer une particule à la position (\a x, \a y), avec
-  la vitesse (\a vx, \a vy) et la masse \a m.
+   Réveille les particules dormantes qui pourraient toucher un obstacle
+   mobile (une requête dans la hiérarchie des mobiles pour chacune de
+   celles qui sont dans la boîte englobante de tous les mobiles).
+*/
+void reveilleParMobiles(Contexte *pCtxt);
 
-  @param p probabilité (entre 0 et 1) qu'une particule soit effectivement créée.
-  @param x la coordonnée x de la position où la particule est créée.
-  @param y la coordonnée y de la position où la particule est créée.
-  @param vx la composante x de la vitesse de la particule.
-  @param vy la composante y de la vitesse de la particule.
-  @param m la masse de la particule créée.
- */
-void fontaine(Contexte *pCtxt, double p,
-              double x, double y, double vx, double vy, double m);
+/**
+   Déplace toutes les particules actives en fonction de leur vitesse. Les
+   particules sont traitées par paquets de voisines (ordre de Morton),
+   et chaque paquet ne fait qu'une requête dans l'arbre k-D. Les paquets
+   sont répartis entre les fils de calcul par blocs de PAQUETS_PAR_BLOC
+   (voir \ref deplacePaquets). Les bords du domaine sont appliqués dans
+   la même passe; ensuite, les particules sorties sont détruites et
+   celles restées lentes assez longtemps s'endorment, en un seul
+   parcours du tableau.
+*/
+void deplaceTout(Contexte *pCtxt);
+
+/**
+   Déplace les particules des paquets [debut,fin[ décrits par le
+   Deplacement \a arg. Chaque particule n'appartient qu'à un paquet, et
+   les obstacles ne sont que lus: des blocs différents peuvent être
+   traités en même temps par des fils différents, chacun avec ses
+   propres tableaux de candidats.
+*/
+void deplacePaquets(void *arg, int debut, int fin);
 
-void fontaineVariable(Contexte *pCtxt,
-                      double p, double var,
-                      double x, double y, double vx, double vy, double m);
+/**
+   Déplace une particule en fonction de sa vitesse, en gérant les
+   collisions avec les obstacles candidats \a F déjà trouvés autour de
+   sa position prédite, et avec ceux du champ de distance \a S s'il
+   n'est pas NULL.
+*/
+void deplaceParticuleParmi(Particule *p, const SDF *S, TabObstacles *F);
 
+/**
+   Réaction au clic sur la zone de dessin: envoie le clic au fil de
+   simulation (voir \ref appliqueCommande). Le bouton du milieu
+   commence un déplacement de la vue.
+*/
 gboolean mouse_clic_reaction(GtkWidget *widget, GdkEventButton *event, gpointer data);
 
+/**
+   Réaction au déplacement de la souris: tant que le bouton gauche est
+   enfoncé, envoie la position au fil de simulation, qui y déplace
+   l'obstacle sélectionné. Tant que le bouton du milieu est enfoncé,
+   fait glisser la vue.
+*/
+gboolean mouse_move_reaction(GtkWidget *widget, GdkEventMotion *event, gpointer data);
+
+/**
+   Réaction au relâchement d'un bouton de la souris: termine le déplacement.
+*/
+gboolean mouse_release_reaction(GtkWidget *widget, GdkEventButton *event, gpointer data);
+
+/**
+   Réaction à la molette: zoome ou dézoome d'un facteur ZOOM_PAS, en
+   gardant fixe le point sous la souris.
+*/
+gboolean mouse_scroll_reaction(GtkWidget *widget, GdkEventScroll *event, gpointer data);
+
+/**
+   Cherche l'obstacle sous le point \a p (en coordonnées réelles) grâce
+   à l'arbre k-D: c'est l'obstacle le plus proche, s'il est à moins de
+   son rayon ou de \a r_dessin (la taille de son dessin à l'écran).
+
+   @return l'indice de cet obstacle dans TabO, ou -1 s'il n'y en a pas.
+*/
+int obstacleSousPoint(Contexte *pCtxt, Point p, double r_dessin);
+
 
 //-----------------------------------------------------------------------------
 // Programme principal
@@ -163,21 +547,387 @@ gboolean mouse_clic_reaction(GtkWidget *widget, GdkEventButton *event, gpointer
 int main(int argc,
          char *argv[]) {
     Contexte context;
-    TabParticules_init(&context.TabP);
-    TabObstacles_init(&context.TabO);
-    context.kdtree = ArbreVide();
+    Ordonnanceur ordonnanceur;
+    // Retire de argv les options propres au programme:
+    // --sans-ihm N: simule N pas de temps sans fenêtre, puis affiche le profil;
+    // --trace FICHIER: écrit aussi la trace des phases de chaque pas (avec --sans-ihm seulement);
+    // --sdf: utilise le champ de distance pour les collisions (sans fenêtre, en 2D seulement);
+    // --fils N: nombre de fils de calcul (par défaut, un par processeur;
+    //          avec la fenêtre, un de moins pour laisser un processeur à l'interface);
+    // --ensemble PLAN: simule sans fenêtre les mondes du plan d'expériences PLAN
+    //          (PAS_ENSEMBLE pas, ou N avec --sans-ihm N);
+    // --sortie FICHIER: où écrire les statistiques de l'ensemble (ensemble.txt par défaut);
+    // --histo PREFIXE: écrit l'histogramme des particules dans PREFIXE_PAS.csv;
+    // --histo-periode N: nombre de pas moyennés par fichier d'histogramme (HISTO_PERIODE par défaut);
+    // --histo-binaire: écrit les histogrammes en binaire (PREFIXE_PAS.bin).
+    int nb_pas = 0;
+    int nb_fils = 0;
+    const char *trace = NULL;
+    const char *plan = NULL;
+    const char *sortie = "ensemble.txt";
+    OptionsHisto histo = {NULL, HISTO_PERIODE, HISTO_CSV};
+    context.sdf_actif = false;
+    int m = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--sans-ihm") == 0 && i + 1 < argc)
+            nb_pas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace = argv[++i];
+        else if (strcmp(argv[i], "--fils") == 0 && i + 1 < argc)
+            nb_fils = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ensemble") == 0 && i + 1 < argc)
+            plan = argv[++i];
+        else if (strcmp(argv[i], "--sortie") == 0 && i + 1 < argc)
+            sortie = argv[++i];
+        else if (strcmp(argv[i], "--histo") == 0 && i + 1 < argc)
+            histo.prefixe = argv[++i];
+        else if (strcmp(argv[i], "--histo-periode") == 0 && i + 1 < argc)
+            histo.periode = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1;
+        else if (strcmp(argv[i], "--histo-binaire") == 0)
+            histo.format = HISTO_BINAIRE;
+        else if (strcmp(argv[i], "--sdf") == 0)
+            context.sdf_actif = true;
+        else
+            argv[m++] = argv[i];
+    }
+    argc = m;
+    argv[argc] = NULL;
+    // Avec la fenêtre, la trace grossirait sans fin sans jamais être écrite.
+    if (trace != NULL && nb_pas == 0 && plan == NULL) {
+        fprintf(stderr, "--trace demande --sans-ihm N\n");
+        return 1;
+    }
+    if (context.sdf_actif && DIM != 2) {
+        fprintf(stderr, "--sdf n'est disponible qu'en 2D\n");
+        return 1;
+    }
+
+    if (plan != NULL && nb_pas == 0)
+        nb_pas = PAS_ENSEMBLE;
+    Ordonnanceur_init(&ordonnanceur, nb_fils == 0 && nb_pas == 0 ? -1 : nb_fils);
+    if (plan != NULL)
+        return simuleEnsemble(plan, sortie, nb_pas, &ordonnanceur, context.sdf_actif, &histo);
 
     /* Passe les arguments à GTK, pour qu'il extrait ceux qui le concernent. */
-    gtk_init(&argc, &argv);
+    if (nb_pas == 0)
+        gtk_init(&argc, &argv);
+
+    /* Charge la scène donnée en argument, s'il y en a une. */
+    if (initMonde(&context, &ordonnanceur, argc > 1 ? argv[1] : NULL, trace != NULL) < 0) {
+        Ordonnanceur_termine(&ordonnanceur);
+        return 1;
+    }
+    activeHistogramme(&context, &histo, -1);
+    Profil_init(&context.profil_affichage, 0);
+    context.resume[0] = '\0';
+    FileCommandes_init(&context.commandes);
+    EchangeTrames_init(&context.trames);
+    context.arret = 0;
+
+    if (nb_pas > 0) {
+        for (int k = 0; k < nb_pas; ++k)
+            pasDeTemps(&context);
+        termineHistogramme(&context);
+        char texte[1024];
+        Profil_resume(&context.profil, texte, sizeof(texte));
+        printf("%d pas, %d points (%d dormants)\n%s\n", nb_pas, TabParticules_nb(&context.TabP),
+               TabParticules_nbDormantes(&context.TabP), texte);
+        int ok = trace == NULL || Profil_ecritTrace(&context.profil, trace) == 0;
+        termineDecor(&context);
+        Ordonnanceur_termine(&ordonnanceur);
+        return ok ? 0 : 1;
+    }
 
     /* Crée une fenêtre. */
     creerIHM(&context);
 
+    /* Lance la simulation dans son propre fil, avec une première trame à afficher. */
+    publieTrame(&context);
+    pthread_create(&context.fil_simulation, NULL, boucleSimulation, &context);
+
     /* Rentre dans la boucle d'événements. */
     gtk_main();
+
+    __atomic_store_n(&context.arret, 1, __ATOMIC_RELEASE);
+    pthread_join(context.fil_simulation, NULL);
+    termineDecor(&context);
+    Ordonnanceur_termine(&ordonnanceur);
+    EchangeTrames_termine(&context.trames);
+    Carte_termine(&context.carte);
+    if (context.image_arbre != NULL)
+        cairo_surface_destroy(context.image_arbre);
+    Profil_termine(&context.profil_affichage);
+    return 0;
+}
+
+int initMonde(Contexte *pCtxt, Ordonnanceur *O, const char *scene, bool trace) {
+    TabParticules_init(&pCtxt->TabP);
+    TabObstacles_init(&pCtxt->TabO);
+    TabEmetteurs_init(&pCtxt->TabE);
+    IndexObstacles_init(&pCtxt->index, &pCtxt->TabO);
+    Mobiles_init(&pCtxt->mobiles);
+    TabObstacles_init(&pCtxt->murs);
+    BVH_init(&pCtxt->bvh_murs, &pCtxt->murs);
+    Domaine_init(&pCtxt->domaine, -1.5, -1.5, 1.5, 1.5, BORD_OUVERT, BORD_OUVERT);
+    TriMorton_init(&pCtxt->tri);
+    pCtxt->pas = 0;
+    pCtxt->selection = -1;
+    pCtxt->glisse = false;
+    pCtxt->ordonnanceur = O;
+    int nb_fils = Ordonnanceur_nbFils(O);
+    pCtxt->candidats = (TabObstacles *) malloc(nb_fils * KDT_PAQUET * sizeof(TabObstacles));
+    for (int i = 0; i < nb_fils * KDT_PAQUET; ++i)
+        TabObstacles_init(&pCtxt->candidats[i]);
+    pCtxt->temps_fils = (int64_t *) malloc(nb_fils * NB_PHASES * sizeof(int64_t));
+    // Les grands arbres k-D sont construits en parallèle.
+    Arene_parallele(&pCtxt->index.arene, O);
+    Alea_init(&pCtxt->alea, GRAINE, 0);
+    Profil_init(&pCtxt->profil, trace);
+    pCtxt->histo = NULL;
+    // Crée les forces
+    Force g = gravite(0.0, -0.2);
+    pCtxt->forces[0] = g;
+    pCtxt->forces_avant[0] = g;
+
+    if (scene != NULL) {
+        if (Scene_charge(scene, &pCtxt->TabE, &pCtxt->TabO, &pCtxt->murs, &pCtxt->mobiles,
+                         &pCtxt->domaine, GRAINE) < 0) {
+            // Le champ n'alloue rien avant d'être calculé: il n'est initialisé que pour être libéré.
+            SDF_init(&pCtxt->sdf, &pCtxt->index, pCtxt->domaine.bmin, pCtxt->domaine.bmax, SDF_PAS,
+                     RAYON_CANDIDATS);
+            termineDecor(pCtxt);
+            return -1;
+        }
+        // Un seul arbre pour tous les obstacles de la scène.
+        IndexObstacles_reconstruit(&pCtxt->index);
+        // Les murs ne bougent pas: leur hiérarchie est construite une fois pour toutes.
+        BVH_Construit(&pCtxt->bvh_murs);
+    } else
+        emetteursParDefaut(pCtxt);
+    SDF_init(&pCtxt->sdf, &pCtxt->index, pCtxt->domaine.bmin, pCtxt->domaine.bmax, SDF_PAS,
+             RAYON_CANDIDATS + pCtxt->index.r_max);
     return 0;
 }
 
+void copieMonde(Contexte *pCtxt, Contexte *decor, int flux, double att, double debit) {
+    TabParticules_init(&pCtxt->TabP);
+    TabObstacles_init(&pCtxt->TabO);
+    TabObstacles_copie(&pCtxt->TabO, &decor->TabO);
+    TabObstacles_init(&pCtxt->murs);
+    TabObstacles_copie(&pCtxt->murs, &decor->murs);
+    Mobiles_init(&pCtxt->mobiles);
+    Mobiles_copie(&pCtxt->mobiles, &decor->mobiles);
+    if (att >= 0.0) {
+        TabObstacles *T[3] = {&pCtxt->TabO, &pCtxt->murs, &pCtxt->mobiles.O};
+        for (int k = 0; k < 3; ++k)
+            for (int i = 0; i < TabObstacles_nb(T[k]); ++i)
+                TabObstacles_ref(T[k], i)->att = att;
+    }
+    // Copies superficielles: les noeuds restent ceux du décor, et ne
+    // sont jamais modifiés ni libérés par le monde.
+    pCtxt->index = decor->index;
+    pCtxt->index.O = &pCtxt->TabO;
+    pCtxt->bvh_murs = decor->bvh_murs;
+    pCtxt->bvh_murs.O = &pCtxt->murs;
+    pCtxt->domaine = decor->domaine;
+    int nb_emetteurs = TabEmetteurs_nb(&decor->TabE);
+    TabEmetteurs_init(&pCtxt->TabE);
+    for (int i = 0; i < nb_emetteurs; ++i) {
+        Emetteur e = *TabEmetteurs_ref(&decor->TabE, i);
+        Alea_init(&e.alea, GRAINE, flux + 1 + i);
+        e.debit *= debit;
+        TabEmetteurs_ajoute(&pCtxt->TabE, e);
+    }
+    Alea_init(&pCtxt->alea, GRAINE, flux);
+    pCtxt->sdf_actif = decor->sdf_actif;
+    SDF_init(&pCtxt->sdf, &pCtxt->index, pCtxt->domaine.bmin, pCtxt->domaine.bmax, SDF_PAS,
+             RAYON_CANDIDATS + pCtxt->index.r_max);
+    TriMorton_init(&pCtxt->tri);
+    pCtxt->pas = 0;
+    pCtxt->selection = -1;
+    pCtxt->glisse = false;
+    pCtxt->ordonnanceur = decor->ordonnanceur;
+    int nb_fils = Ordonnanceur_nbFils(pCtxt->ordonnanceur);
+    pCtxt->candidats = (TabObstacles *) malloc(nb_fils * KDT_PAQUET * sizeof(TabObstacles));
+    for (int i = 0; i < nb_fils * KDT_PAQUET; ++i)
+        TabObstacles_init(&pCtxt->candidats[i]);
+    pCtxt->temps_fils = (int64_t *) malloc(nb_fils * NB_PHASES * sizeof(int64_t));
+    Profil_init(&pCtxt->profil, 0);
+    pCtxt->histo = NULL;
+    for (int j = 0; j < NB_FORCES; ++j) {
+        pCtxt->forces[j] = decor->forces[j];
+        pCtxt->forces_avant[j] = decor->forces_avant[j];
+    }
+}
+
+void termineMonde(Contexte *pCtxt) {
+    TabParticules_termine(&pCtxt->TabP);
+    TabObstacles_termine(&pCtxt->TabO);
+    TabEmetteurs_termine(&pCtxt->TabE);
+    Mobiles_termine(&pCtxt->mobiles);
+    TabObstacles_termine(&pCtxt->murs);
+    SDF_termine(&pCtxt->sdf);
+    TriMorton_termine(&pCtxt->tri);
+    int nb_fils = Ordonnanceur_nbFils(pCtxt->ordonnanceur);
+    for (int i = 0; i < nb_fils * KDT_PAQUET; ++i)
+        TabObstacles_termine(&pCtxt->candidats[i]);
+    free(pCtxt->candidats);
+    pCtxt->candidats = NULL;
+    free(pCtxt->temps_fils);
+    pCtxt->temps_fils = NULL;
+    termineHistogramme(pCtxt);
+    Profil_termine(&pCtxt->profil);
+}
+
+void termineDecor(Contexte *pCtxt) {
+    IndexObstacles_termine(&pCtxt->index);
+    BVH_termine(&pCtxt->bvh_murs);
+    termineMonde(pCtxt);
+}
+
+void activeHistogramme(Contexte *pCtxt, const OptionsHisto *opt, int numero) {
+    if (opt->prefixe == NULL)
+        return;
+    pCtxt->options_histo = opt;
+    if (numero < 0)
+        snprintf(pCtxt->nom_histo, sizeof(pCtxt->nom_histo), "%s", opt->prefixe);
+    else
+        snprintf(pCtxt->nom_histo, sizeof(pCtxt->nom_histo), "%s_monde%d", opt->prefixe, numero);
+    pCtxt->histo = (Histogramme *) malloc(sizeof(Histogramme));
+    Histogramme_init(pCtxt->histo, pCtxt->domaine.bmin, pCtxt->domaine.bmax, HISTO_CELLULES, HISTO_CELLULES,
+                     pCtxt->ordonnanceur);
+}
+
+void ecritHistogramme(Contexte *pCtxt) {
+    const OptionsHisto *opt = pCtxt->options_histo;
+    char nom[300];
+    snprintf(nom, sizeof(nom), "%s_%06d.%s", pCtxt->nom_histo, pCtxt->pas,
+             opt->format == HISTO_BINAIRE ? "bin" : "csv");
+    Histogramme_ecrit(pCtxt->histo, nom, opt->format);
+}
+
+void termineHistogramme(Contexte *pCtxt) {
+    if (pCtxt->histo == NULL)
+        return;
+    if (pCtxt->histo->nb_pas > 0)
+        ecritHistogramme(pCtxt);
+    Histogramme_termine(pCtxt->histo);
+    free(pCtxt->histo);
+    pCtxt->histo = NULL;
+}
+
+void statsMonde(Contexte *pCtxt, StatsMonde *s) {
+    TabParticules *P = &pCtxt->TabP;
+    int n = TabParticules_nb(P);
+    double somme_v = 0.0, energie = 0.0;
+    for (int i = 0; i < n; ++i) {
+        Particule *p = TabParticules_ref(P, i);
+        double v2 = 0.0;
+        for (int k = 0; k < DIM; ++k)
+            v2 += p->v[k] * p->v[k];
+        somme_v += sqrt(v2);
+        energie += 0.5 * p->m * v2;
+    }
+    s->particules = n;
+    s->dormantes = TabParticules_nbDormantes(P);
+    s->vitesse = n > 0 ? somme_v / n : 0.0;
+    s->energie = energie;
+}
+
+// Temps total passé par le fil courant à simuler des mondes (en ns).
+__thread int64_t temps_mondes = 0;
+
+void simuleMondes(void *arg, int debut, int fin) {
+    Ensemble *E = (Ensemble *) arg;
+    for (int k = debut; k < fin; ++k) {
+        int64_t avant = temps_mondes;
+        int64_t t = Profil_debut();
+        for (int p = 0; p < E->nb_pas; ++p)
+            pasDeTemps(E->mondes + k);
+        statsMonde(E->mondes + k, E->stats + k);
+        int64_t duree = Profil_debut() - t;
+        // Les mondes imbriqués ont ajouté leur durée à temps_mondes.
+        int64_t imbriques = temps_mondes - avant;
+        E->stats[k].us_par_pas = (duree - imbriques) * 1e-3 / E->nb_pas;
+        temps_mondes = avant + duree;
+        termineHistogramme(E->mondes + k);
+    }
+}
+
+int simuleEnsemble(const char *nom_plan, const char *sortie, int nb_pas, Ordonnanceur *O, bool sdf_actif,
+                   const OptionsHisto *histo) {
+    Plan plan;
+    if (Plan_charge(nom_plan, &plan) < 0) {
+        Ordonnanceur_termine(O);
+        return 1;
+    }
+    if (plan.nb_mondes == 0) {
+        fprintf(stderr, "%s: aucun monde à simuler\n", nom_plan);
+        Plan_termine(&plan);
+        Ordonnanceur_termine(O);
+        return 1;
+    }
+    // Un décor par scène différente; decor_de[l] est celui de la ligne l du plan.
+    Contexte *decors = (Contexte *) malloc(plan.nb * sizeof(Contexte));
+    int *decor_de = (int *) malloc(plan.nb * sizeof(int));
+    int nb_decors = 0;
+    for (int l = 0; l < plan.nb; ++l) {
+        const char *scene = plan.lignes[l].scene;
+        int d = 0;
+        while (d < l && strcmp(plan.lignes[d].scene, scene) != 0)
+            ++d;
+        if (d < l) {
+            decor_de[l] = decor_de[d];
+            continue;
+        }
+        decor_de[l] = nb_decors;
+        Contexte *D = decors + nb_decors++;
+        D->sdf_actif = sdf_actif;
+        if (initMonde(D, O, strcmp(scene, "-") == 0 ? NULL : scene, false) < 0) {
+            // initMonde a déjà libéré le décor qui n'a pas pu être chargé.
+            for (int e = 0; e < nb_decors - 1; ++e)
+                termineDecor(decors + e);
+            free(decors);
+            free(decor_de);
+            Plan_termine(&plan);
+            Ordonnanceur_termine(O);
+            return 1;
+        }
+    }
+    Contexte *mondes = (Contexte *) malloc(plan.nb_mondes * sizeof(Contexte));
+    // Les flux aléatoires des mondes se suivent sans se chevaucher, même
+    // si leurs scènes n'ont pas le même nombre d'émetteurs.
+    int flux = 0;
+    for (int l = 0; l < plan.nb; ++l) {
+        const LignePlan *L = plan.lignes + l;
+        Contexte *decor = decors + decor_de[l];
+        for (int k = L->premier; k < L->premier + L->repetitions; ++k) {
+            copieMonde(mondes + k, decor, flux, L->att, L->debit);
+            flux += TabEmetteurs_nb(&decor->TabE) + 1;
+            activeHistogramme(mondes + k, histo, k);
+        }
+    }
+    StatsMonde *stats = (StatsMonde *) malloc(plan.nb_mondes * sizeof(StatsMonde));
+    Ensemble E = {mondes, stats, nb_pas};
+    int64_t t = Profil_debut();
+    Ordonnanceur_parallele(O, plan.nb_mondes, 1, simuleMondes, &E);
+    printf("%d mondes (%d scènes), %d pas, %d fils: %.2f s\n", plan.nb_mondes, nb_decors, nb_pas,
+           Ordonnanceur_nbFils(O), (Profil_debut() - t) * 1e-9);
+    int ok = Ensemble_ecrit(sortie, &plan, nb_pas, stats) == 0;
+    // Les mondes d'abord: ils partagent les arbres de leur décor.
+    for (int k = 0; k < plan.nb_mondes; ++k)
+        termineMonde(mondes + k);
+    for (int d = 0; d < nb_decors; ++d)
+        termineDecor(decors + d);
+    free(stats);
+    free(mondes);
+    free(decors);
+    free(decor_de);
+    Plan_termine(&plan);
+    Ordonnanceur_termine(O);
+    return ok ? 0 : 1;
+}
+
 gboolean realize_evt_reaction(GtkWidget *widget, gpointer data) { // force un événement "expose" juste derrière.
     gtk_widget_queue_draw(widget);
     return TRUE;
@@ -190,78 +940,164 @@ double min(double a, double b) {
 gboolean expose_evt_reaction(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
     // c'est la réaction principale qui va redessiner tout.
     Contexte *pCtxt = (Contexte *) data;
-    TabParticules *ptrP = &(pCtxt->TabP);
-    TabObstacles *ptrO = &(pCtxt->TabO);
+    int64_t t = Profil_debut();
+    // On ne dessine que la dernière trame publiée par le fil de simulation.
+    Trame *T = EchangeTrames_derniere(&pCtxt->trames);
     // c'est la structure qui permet d'afficher dans une zone de dessin
     // via Cairo
     cairo_t *cr = gdk_cairo_create(widget->window);
     cairo_set_source_rgb(cr, 1, 1, 1); // choisit le blanc.
     cairo_paint(cr); // remplit tout dans la couleur choisie.
 
-    // Affiche tous les points en bleu.
+    // Le rectangle visible, élargi de la taille des dessins qui peuvent
+    // dépasser du bord, et les cellules de particules qui le touchent.
+    double bmin[2], bmax[2];
+    rectangleVisible(pCtxt, RAYON_OBSTACLE_AFF, bmin, bmax);
+    int plage[4];
+    Trame_plage(T, bmin, bmax, plage);
+
+    // Affiche les points visibles, du bleu (lents) au rouge (rapides).
     double c1[3] = {0, 0, 1};
     double c2[3] = {1, 0, 0};
-    double vMax = 1.5;
-    for (int i = 0; i < TabParticules_nb(ptrP); ++i) {
-        Particule p = TabParticules_get(ptrP, i);
-        double vitesse = sqrt((p.x[0] * p.x[0]) + (p.x[1] * p.x[1]));
-        double lambda = min(vitesse / vMax, 1.0);
-        cairo_set_source_rgb(cr,
-                             (1 - lambda) * c1[0] + lambda * c2[0],
-                             (1 - lambda) * c1[1] + lambda * c2[1],
-                             (1 - lambda) * c1[2] + lambda * c2[2]
-        );
-        drawParticule(pCtxt, cr, p);
-    }
-
-    // Affiche tous les obstacle
-    for (int i = 0; i < TabObstacles_nb(ptrO); ++i) {
-        Obstacle o = TabObstacles_get(ptrO, i);
-        cairo_set_source_rgb(cr, o.cr, o.cg, o.cb);
+    double vMax = VITESSE_MAX_AFF;
+    if (T->nb_particules > CARTE_SEUIL
+        || gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(pCtxt->bouton_carte)))
+        drawCarte(pCtxt, cr, T, plage);
+    else
+        for (int j = plage[2]; j <= plage[3]; ++j) {
+            // Les cellules d'une ligne de la grille se suivent dans la trame.
+            int debut = T->debut_cellule[j * TRAME_GRILLE + plage[0]];
+            int fin = T->debut_cellule[j * TRAME_GRILLE + plage[1] + 1];
+            for (int i = debut; i < fin; ++i) {
+                const ParticuleTrame *p = T->particules + i;
+                if (p->x < bmin[0] || p->x > bmax[0] || p->y < bmin[1] || p->y > bmax[1])
+                    continue;
+                double lambda = min(p->v / vMax, 1.0);
+                cairo_set_source_rgb(cr,
+                                     (1 - lambda) * c1[0] + lambda * c2[0],
+                                     (1 - lambda) * c1[1] + lambda * c2[1],
+                                     (1 - lambda) * c1[2] + lambda * c2[2]
+                );
+                drawParticule(pCtxt, cr, p);
+            }
+        }
+
+    // Affiche les obstacles visibles
+    if (T->nb_noeuds > 0)
+        drawObstacles(pCtxt, cr, T, T->noeuds, 0, bmin, bmax, 0);
+
+    // Affiche les murs visibles
+    for (int i = 0; i < TabObstacles_nb(&T->murs); ++i) {
+        const Obstacle *o = TabObstacles_ref(&T->murs, i);
+        double r = o->type == CAPSULE ? o->r : 0.0;
+        if (fmax(o->x[0], o->x2[0]) + r < bmin[0] || fmin(o->x[0], o->x2[0]) - r > bmax[0]
+            || fmax(o->x[1], o->x2[1]) + r < bmin[1] || fmin(o->x[1], o->x2[1]) - r > bmax[1])
+            continue;
+        drawMur(pCtxt, cr, o);
+    }
+
+    // Affiche les obstacles mobiles visibles
+    for (int i = 0; i < TabObstacles_nb(&T->mobiles); ++i) {
+        Obstacle *o = TabObstacles_ref(&T->mobiles, i);
+        if (o->x[0] + o->r < bmin[0] || o->x[0] - o->r > bmax[0]
+            || o->x[1] + o->r < bmin[1] || o->x[1] - o->r > bmax[1])
+            continue;
+        cairo_set_source_rgb(cr, o->cr, o->cg, o->cb);
+        Point p;
+        p.x[0] = o->x[0];
+        p.x[1] = o->x[1];
+        p = point2DrawingAreaPoint(pCtxt, p);
+        drawPoint(cr, p.x[0], p.x[1], length2DrawingAreaLength(pCtxt, o->r));
+    }
+
+    // Entoure l'obstacle sélectionné
+    if (T->selection >= 0) {
+        Obstacle *o = TabObstacles_ref(&T->obstacles, T->selection);
         Point p;
-        p.x[0] = o.x[0];
-        p.x[1] = o.x[1];
+        p.x[0] = o->x[0];
+        p.x[1] = o->x[1];
         p = point2DrawingAreaPoint(pCtxt, p);
-        drawPoint(cr, p.x[0], p.x[1], 10);
+        cairo_set_source_rgb(cr, 1.0, 0.5, 0.0);
+        cairo_set_line_width(cr, 2.0);
+        cairo_new_sub_path(cr);
+        cairo_arc(cr, p.x[0], p.x[1], 13, 0.0, 2.0 * 3.14159626);
+        cairo_stroke(cr);
     }
 
-    /*
-    Point bg = {{-10.0, -10.0}};
-    Point hd = {{10.0, 10.0}};
-    viewerKDTree(pCtxt, cr, Racine(pCtxt->kdtree), bg, hd, 0);
-     */
+    // Affiche l'arbre k-D, s'il est demandé et déjà recopié par la simulation.
+    if (T->version_arbre >= 0
+        && gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(pCtxt->bouton_arbre)))
+        drawArbre(pCtxt, cr, T);
 
     // On a fini, on peut détruire la structure.
     cairo_destroy(cr);
+    Profil_fin(&pCtxt->profil_affichage, PHASE_AFFICHAGE, t);
     return TRUE;
 }
 
+void rectangleVisible(Contexte *pCtxt, double marge, double bmin[2], double bmax[2]) {
+    Point p = {{-marge, pCtxt->height + marge}};
+    Point q = {{pCtxt->width + marge, -marge}};
+    p = drawingAreaPoint2Point(pCtxt, p);
+    q = drawingAreaPoint2Point(pCtxt, q);
+    for (int a = 0; a < 2; ++a) {
+        bmin[a] = p.x[a];
+        bmax[a] = q.x[a];
+    }
+}
+
 Point point2DrawingAreaPoint(Contexte *pCtxt, Point p) {
     Point q;
-    q.x[0] = (p.x[0] + 1.0) / 2.0 * pCtxt->width;
-    q.x[1] = (1.0 - p.x[1]) / 2.0 * pCtxt->height;
+    double echelle = length2DrawingAreaLength(pCtxt, 1.0);
+    q.x[0] = pCtxt->width / 2.0 + (p.x[0] - pCtxt->vue.centre[0]) * echelle;
+    q.x[1] = pCtxt->height / 2.0 - (p.x[1] - pCtxt->vue.centre[1]) * echelle;
     return q;
 }
 
 double length2DrawingAreaLength(Contexte *pCtxt, double l) {
-    return pCtxt->width * l / 2.0;
+    return pCtxt->width * pCtxt->vue.zoom * l / 2.0;
 }
 
 Point drawingAreaPoint2Point(Contexte *pCtxt, Point p) {
     Point q;
-    q.x[0] = 2.0 * ((double) p.x[0] / (double) pCtxt->width) - 1.0;
-    q.x[1] = -2.0 * ((double) p.x[1] / (double) pCtxt->height) + 1.0;
+    // En 3D, on clique dans le plan z = 0.
+    for (int k = 2; k < DIM; ++k)
+        q.x[k] = 0.0;
+    double echelle = length2DrawingAreaLength(pCtxt, 1.0);
+    q.x[0] = pCtxt->vue.centre[0] + (p.x[0] - pCtxt->width / 2.0) / echelle;
+    q.x[1] = pCtxt->vue.centre[1] - (p.x[1] - pCtxt->height / 2.0) / echelle;
     return q;
 }
 
-void drawParticule(Contexte *pCtxt, cairo_t *cr, Particule p) {
+void drawParticule(Contexte *pCtxt, cairo_t *cr, const ParticuleTrame *p) {
     Point pp;
-    pp.x[0] = p.x[0];
-    pp.x[1] = p.x[1];
-    // On convertit les coordonnées réelles des particules (dans [-1:1]x[-1:1]) en coordonnées
-    // de la zone de dessin (dans [0:499]x[0:499]).
+    pp.x[0] = p->x;
+    pp.x[1] = p->y;
+    // On convertit les coordonnées réelles des particules en coordonnées
+    // de la zone de dessin, selon la vue.
     Point q = point2DrawingAreaPoint(pCtxt, pp);
-    drawPoint(cr, q.x[0], q.x[1], 1.5 * sqrt(p.m));
+    drawPoint(cr, q.x[0], q.x[1], 1.5 * sqrt(p->m));
+}
+
+void drawCarte(Contexte *pCtxt, cairo_t *cr, const Trame *T, const int plage[4]) {
+    // La même transformation que point2DrawingAreaPoint.
+    double e = length2DrawingAreaLength(pCtxt, 1.0);
+    double echelle[2] = {e, -e};
+    double origine[2] = {pCtxt->width / 2.0 - pCtxt->vue.centre[0] * e,
+                         pCtxt->height / 2.0 + pCtxt->vue.centre[1] * e};
+    Carte *C = &pCtxt->carte;
+    Carte_efface(C, pCtxt->width, pCtxt->height);
+    for (int j = plage[2]; j <= plage[3]; ++j) {
+        int debut = T->debut_cellule[j * TRAME_GRILLE + plage[0]];
+        int fin = T->debut_cellule[j * TRAME_GRILLE + plage[1] + 1];
+        Carte_ajoute(C, T->particules + debut, fin - debut, echelle, origine);
+    }
+    Carte_colorie(C, VITESSE_MAX_AFF);
+    cairo_surface_t *image = cairo_image_surface_create_for_data((unsigned char *) C->pixels, CAIRO_FORMAT_RGB24,
+                                                                 C->largeur, C->hauteur, 4 * C->largeur);
+    cairo_set_source_surface(cr, image, 0, 0);
+    cairo_paint(cr);
+    cairo_surface_destroy(image);
 }
 
 void drawPoint(cairo_t *cr, double x, double y, double r) {
@@ -269,33 +1105,101 @@ void drawPoint(cairo_t *cr, double x, double y, double r) {
     cairo_fill(cr);
 }
 
-void viewerKDTree(Contexte *pCtxt, cairo_t *cr, Noeud *N, Point bg, Point hd, int a) {
-    if (N != ArbreVide()) {
-        int b = (a + 1) % DIM;
-        Obstacle *q = Valeur(N);
-        Point p, p1, p2;
-        p1.x[a] = q->x[a];
-        p1.x[b] = bg.x[b];
-        p2.x[a] = q->x[a];
-        p2.x[b] = hd.x[b];
-        cairo_set_source_rgb(cr, 0.0, 1.0, 1.0);
-        Point draw_p1 = point2DrawingAreaPoint(pCtxt, p1);
-        Point draw_p2 = point2DrawingAreaPoint(pCtxt, p2);
-        cairo_move_to(cr, draw_p1.x[0], draw_p1.x[1]);
-        cairo_line_to(cr, draw_p2.x[0], draw_p2.x[1]);
-        cairo_stroke(cr);
-        cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
-        p.x[0] = q->x[0];
-        p.x[1] = q->x[1];
-        Point dp = point2DrawingAreaPoint(pCtxt, p);
-        drawPoint(cr, dp.x[0], dp.x[1], 3);
-        Point hd2 = hd;
-        hd2.x[a] = q->x[a];
-        Point bg2 = bg;
-        bg2.x[a] = q->x[a];
-        viewerKDTree(pCtxt, cr, Gauche(N), bg, hd2, b);
-        viewerKDTree(pCtxt, cr, Droit(N), bg2, hd, b);
+void drawObstacles(Contexte *pCtxt, cairo_t *cr, Trame *T, const NoeudTrame *N, int i,
+                   const double bmin[2], const double bmax[2], int a) {
+    const NoeudTrame *n = N + i;
+    if (!n->supprime && n->x >= bmin[0] && n->x <= bmax[0] && n->y >= bmin[1] && n->y <= bmax[1]) {
+        const Obstacle *o = TabObstacles_ref(&T->obstacles, n->indice);
+        cairo_set_source_rgb(cr, o->cr, o->cg, o->cb);
+        Point p = {{n->x, n->y}};
+        p = point2DrawingAreaPoint(pCtxt, p);
+        drawPoint(cr, p.x[0], p.x[1], RAYON_OBSTACLE_AFF);
     }
+    // En 3D, une coupe selon z ne sépare rien dans le plan: on descend des deux côtés.
+    double x = a == 0 ? n->x : n->y;
+    int b = (a + 1) % DIM;
+    if (n->nb_gauche > 0 && (a >= 2 || bmin[a] <= x))
+        drawObstacles(pCtxt, cr, T, N, i + 1, bmin, bmax, b);
+    if (n->nb_droit > 0 && (a >= 2 || bmax[a] >= x))
+        drawObstacles(pCtxt, cr, T, N, i + 1 + n->nb_gauche, bmin, bmax, b);
+}
+
+void drawArbre(Contexte *pCtxt, cairo_t *cr, const Trame *T) {
+    cairo_surface_t *image = pCtxt->image_arbre;
+    if (image == NULL || cairo_image_surface_get_width(image) != pCtxt->width
+        || cairo_image_surface_get_height(image) != pCtxt->height) {
+        if (image != NULL)
+            cairo_surface_destroy(image);
+        image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, pCtxt->width, pCtxt->height);
+        pCtxt->image_arbre = image;
+        pCtxt->version_image_arbre = -1;
+    }
+    const Vue *v = &pCtxt->vue_image_arbre;
+    if (pCtxt->version_image_arbre != T->version_arbre || v->zoom != pCtxt->vue.zoom
+        || v->centre[0] != pCtxt->vue.centre[0] || v->centre[1] != pCtxt->vue.centre[1]) {
+        // Les droites et les points sont chacun un seul chemin, tracé d'un coup.
+        cairo_t *traits = cairo_create(image);
+        cairo_t *points = cairo_create(image);
+        cairo_set_operator(traits, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(traits);
+        cairo_set_operator(traits, CAIRO_OPERATOR_OVER);
+        cairo_set_antialias(traits, CAIRO_ANTIALIAS_NONE);
+        cairo_set_antialias(points, CAIRO_ANTIALIAS_NONE);
+        if (T->nb_noeuds > 0) {
+            double vmin[2], vmax[2];
+            rectangleVisible(pCtxt, 0.0, vmin, vmax);
+            Point bmin = {{vmin[0], vmin[1]}};
+            Point bmax = {{vmax[0], vmax[1]}};
+            traceNoeuds(pCtxt, traits, points, T->noeuds, 0, bmin, bmax, 0);
+        }
+        cairo_set_source_rgb(traits, 0.0, 1.0, 1.0);
+        cairo_set_line_width(traits, 1.0);
+        cairo_stroke(traits);
+        cairo_set_source_rgb(points, 1.0, 0.0, 0.0);
+        cairo_fill(points);
+        cairo_destroy(traits);
+        cairo_destroy(points);
+        pCtxt->version_image_arbre = T->version_arbre;
+        pCtxt->vue_image_arbre = pCtxt->vue;
+    }
+    cairo_set_source_surface(cr, image, 0, 0);
+    cairo_paint(cr);
+}
+
+void traceNoeuds(Contexte *pCtxt, cairo_t *traits, cairo_t *points, const NoeudTrame *N, int i,
+                 Point bmin, Point bmax, int a) {
+    if (bmax.x[0] <= bmin.x[0] || bmax.x[1] <= bmin.x[1])
+        return;
+    if (length2DrawingAreaLength(pCtxt, bmax.x[0] - bmin.x[0]) < ARBRE_SEUIL_PIXELS
+        || length2DrawingAreaLength(pCtxt, bmax.x[1] - bmin.x[1]) < ARBRE_SEUIL_PIXELS)
+        return;
+    const NoeudTrame *n = N + i;
+    Point p = {{n->x, n->y}};
+    if (!n->supprime && p.x[0] >= bmin.x[0] && p.x[0] <= bmax.x[0]
+        && p.x[1] >= bmin.x[1] && p.x[1] <= bmax.x[1]) {
+        Point q = point2DrawingAreaPoint(pCtxt, p);
+        cairo_rectangle(points, q.x[0] - 1.0, q.x[1] - 1.0, 2.0, 2.0);
+    }
+    int b = (a + 1) % DIM;
+    Point bmax_g = bmax, bmin_d = bmin;
+    // En 3D, une coupe selon z ne se voit pas: les deux fils gardent la cellule.
+    if (a < 2) {
+        Point p1 = bmin, p2 = bmax;
+        p1.x[a] = p.x[a];
+        p2.x[a] = p.x[a];
+        if (p.x[a] > bmin.x[a] && p.x[a] < bmax.x[a]) {
+            p1 = point2DrawingAreaPoint(pCtxt, p1);
+            p2 = point2DrawingAreaPoint(pCtxt, p2);
+            cairo_move_to(traits, p1.x[0], p1.x[1]);
+            cairo_line_to(traits, p2.x[0], p2.x[1]);
+        }
+        bmax_g.x[a] = fmin(bmax.x[a], p.x[a]);
+        bmin_d.x[a] = fmax(bmin.x[a], p.x[a]);
+    }
+    if (n->nb_gauche > 0)
+        traceNoeuds(pCtxt, traits, points, N, i + 1, bmin, bmax_g, b);
+    if (n->nb_droit > 0)
+        traceNoeuds(pCtxt, traits, points, N, i + 1 + n->nb_gauche, bmin_d, bmax, b);
 }
 
 
@@ -305,6 +1209,27 @@ void drawLine(cairo_t *cr, Point p, Point q) {
     cairo_stroke(cr);
 }
 
+void drawMur(Contexte *pCtxt, cairo_t *cr, const Obstacle *o) {
+    Point p, q;
+    p.x[0] = o->x[0];
+    p.x[1] = o->x[1];
+    q.x[0] = o->x2[0];
+    q.x[1] = o->x2[1];
+    p = point2DrawingAreaPoint(pCtxt, p);
+    q = point2DrawingAreaPoint(pCtxt, q);
+    cairo_set_source_rgb(cr, o->cr, o->cg, o->cb);
+    if (o->type == BOITE) {
+        cairo_rectangle(cr, fmin(p.x[0], q.x[0]), fmin(p.x[1], q.x[1]),
+                        fabs(q.x[0] - p.x[0]), fabs(q.x[1] - p.x[1]));
+        cairo_fill(cr);
+        return;
+    }
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+    cairo_set_line_width(cr, o->type == CAPSULE ? 2.0 * length2DrawingAreaLength(pCtxt, o->r) : 2.0);
+    drawLine(cr, p, q);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
+}
+
 /// Charge l'image donnée et crée l'interface.
 GtkWidget *creerIHM(Contexte *pCtxt) {
     GtkWidget *window;
@@ -324,6 +1249,9 @@ GtkWidget *creerIHM(Contexte *pCtxt) {
     pCtxt->drawing_area = gtk_drawing_area_new();
     pCtxt->width = 500;
     pCtxt->height = 500;
+    pCtxt->vue.centre[0] = 0.0;
+    pCtxt->vue.centre[1] = 0.0;
+    pCtxt->vue.zoom = 1.0;
     gtk_widget_set_size_request(pCtxt->drawing_area, pCtxt->width, pCtxt->height);
     // Crée le pixbuf source et le pixbuf destination
     gtk_container_add(GTK_CONTAINER(hbox1), pCtxt->drawing_area);
@@ -342,6 +1270,28 @@ GtkWidget *creerIHM(Contexte *pCtxt) {
     gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->label_distance);
     pCtxt->force_obstacle = gtk_hscale_new_with_range(0, 3, 0.1);
     gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->force_obstacle);
+    pCtxt->bouton_sdf = gtk_check_button_new_with_label("Champ de distance");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(pCtxt->bouton_sdf), pCtxt->sdf_actif);
+    g_signal_connect(G_OBJECT(pCtxt->bouton_sdf), "toggled",
+                     G_CALLBACK(sdf_toggled_reaction), pCtxt);
+    gtk_widget_set_sensitive(pCtxt->bouton_sdf, DIM == 2);
+    gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->bouton_sdf);
+    pCtxt->bouton_carte = gtk_check_button_new_with_label("Carte de densité");
+    gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->bouton_carte);
+    pCtxt->bouton_arbre = gtk_check_button_new_with_label("Arbre k-D");
+    gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->bouton_arbre);
+    GtkWidget *bouton_vue = gtk_button_new_with_label("Vue initiale");
+    g_signal_connect(G_OBJECT(bouton_vue), "clicked",
+                     G_CALLBACK(vue_initiale_reaction), pCtxt);
+    gtk_container_add(GTK_CONTAINER(vbox2), bouton_vue);
+    pCtxt->image_arbre = NULL;
+    pCtxt->version_image_arbre = -1;
+    pCtxt->label_profil = gtk_label_new("");
+    gtk_container_add(GTK_CONTAINER(vbox2), pCtxt->label_profil);
+    // Le même dégradé que celui des particules dans expose_evt_reaction.
+    double c1[3] = {0, 0, 1};
+    double c2[3] = {1, 0, 0};
+    Carte_init(&pCtxt->carte, c1, c2);
 
     // Crée le bouton quitter.
     button_quit = gtk_button_new_with_label("Quitter");
@@ -355,12 +1305,20 @@ GtkWidget *creerIHM(Contexte *pCtxt) {
     // Rajoute la vbox  dans le conteneur window.
     gtk_container_add(GTK_CONTAINER(window), vbox1);
 
-    // Connecte la réaction pour le clic gauche
+    // Connecte les réactions à la souris
     g_signal_connect(G_OBJECT(pCtxt->drawing_area), "button_press_event",
                      G_CALLBACK(mouse_clic_reaction), pCtxt);
+    g_signal_connect(G_OBJECT(pCtxt->drawing_area), "motion_notify_event",
+                     G_CALLBACK(mouse_move_reaction), pCtxt);
+    g_signal_connect(G_OBJECT(pCtxt->drawing_area), "button_release_event",
+                     G_CALLBACK(mouse_release_reaction), pCtxt);
+    g_signal_connect(G_OBJECT(pCtxt->drawing_area), "scroll_event",
+                     G_CALLBACK(mouse_scroll_reaction), pCtxt);
     gtk_widget_set_events(pCtxt->drawing_area, GDK_EXPOSURE_MASK
                                                | GDK_LEAVE_NOTIFY_MASK
                                                | GDK_BUTTON_PRESS_MASK
+                                               | GDK_BUTTON_RELEASE_MASK
+                                               | GDK_SCROLL_MASK
                                                | GDK_POINTER_MOTION_MASK
                                                | GDK_POINTER_MOTION_HINT_MASK);
 
@@ -368,12 +1326,6 @@ GtkWidget *creerIHM(Contexte *pCtxt) {
     gtk_widget_show_all(window);
     g_signal_connect (window, "destroy", G_CALLBACK(gtk_main_quit), NULL);
 
-    // Crée les forces
-    Force g = gravite(0.0, -0.2);
-    pCtxt->forces[0] = g;
-
-    // enclenche le timer pour se déclencher dans 5ms.
-    g_timeout_add(1000 * DT, tic, (gpointer) pCtxt);
     // enclenche le timer pour se déclencher dans 20ms.
     g_timeout_add(1000 * DT_AFF, ticAffichage, (gpointer) pCtxt);
     // enclenche le timer pour se déclencher dans 1000ms.
@@ -382,45 +1334,129 @@ GtkWidget *creerIHM(Contexte *pCtxt) {
     return window;
 }
 
-void fontaine(Contexte *pCtxt,
-              double p, double x, double y, double vx, double vy, double m) {
-    TabParticules *P = &pCtxt->TabP;
-    if ((rand() / (double) RAND_MAX) < p) {
-        Particule q;
-        initParticule(&q, x, y, vx, vy, m);
-        TabParticules_ajoute(P, q);
+void emetteursParDefaut(Contexte *pCtxt) {
+    // Trois jets partant de (-0.5, 0.5): le jet i émet p[i]/DT particules
+    // par seconde, de masse m[i], avec une vitesse uniforme dans
+    // [0.3-var[i], 0.3] x [0.3, 0.3+var[i]].
+    double p[3] = {0.2, 0.25, 0.6};
+    double var[3] = {0.1, 0.2, 0.18};
+    double m[3] = {1.0, 0.5, 2.5};
+    for (int i = 0; i < 3; ++i) {
+        Emetteur e;
+        initEmetteur(&e, -0.5, 0.5, p[i] / DT, 0.3 - var[i] / 2, 0.3 + var[i] / 2, m[i],
+                     GRAINE, i + 1);
+        e.dv = var[i] / 2;
+        TabEmetteurs_ajoute(&pCtxt->TabE, e);
+    }
+}
+
+void pasDeTemps(Contexte *pCtxt) {
+    Profil *prof = &pCtxt->profil;
+    int64_t debut = Profil_debut();
+    int64_t t = debut;
+    for (int i = 0; i < TabEmetteurs_nb(&pCtxt->TabE); ++i)
+        Emetteur_emet(TabEmetteurs_ref(&pCtxt->TabE, i), &pCtxt->TabP, DT);
+    Profil_fin(prof, PHASE_EMISSION, t);
+    if (REORDONNE_TOUS > 0 && pCtxt->pas % REORDONNE_TOUS == 0)
+        reordonneParticules(pCtxt);
+    t = Profil_debut();
+    calculDynamique(pCtxt);
+    Profil_fin(prof, PHASE_DYNAMIQUE, t);
+    Mobiles_avance(&pCtxt->mobiles, DT);
+    // Le champ suit les modifications des obstacles dès qu'il a été calculé.
+    if (!pCtxt->sdf.pret && pCtxt->sdf_actif)
+        SDF_Calcule(&pCtxt->sdf);
+    SDF_MetAJour(&pCtxt->sdf);
+    deplaceTout(pCtxt);
+    ++pCtxt->pas;
+    if (pCtxt->histo != NULL) {
+        t = Profil_debut();
+        Histogramme_accumule(pCtxt->histo, &pCtxt->TabP, pCtxt->ordonnanceur);
+        const OptionsHisto *opt = pCtxt->options_histo;
+        if (pCtxt->pas % opt->periode == 0)
+            ecritHistogramme(pCtxt);
+        Profil_fin(prof, PHASE_HISTO, t);
+    }
+    Profil_finPas(prof, debut);
+}
+
+void *boucleSimulation(void *data) {
+    Contexte *pCtxt = (Contexte *) data;
+    const int64_t dt = (int64_t) (DT * 1e9);
+    int64_t echeance = Profil_debut();
+    while (!__atomic_load_n(&pCtxt->arret, __ATOMIC_ACQUIRE)) {
+        Commande c;
+        while (FileCommandes_recoit(&pCtxt->commandes, &c))
+            appliqueCommande(pCtxt, &c);
+        pasDeTemps(pCtxt);
+        reporteCompteurDistance();
+        if (pCtxt->pas % PAS_RESUME == 0)
+            Profil_resume(&pCtxt->profil, pCtxt->resume, sizeof(pCtxt->resume));
+        if (pCtxt->pas % PAS_PAR_TRAME == 0)
+            publieTrame(pCtxt);
+        // Attend le prochain pas; en retard, on repart de maintenant.
+        echeance += dt;
+        int64_t reste = echeance - Profil_debut();
+        if (reste > 0)
+            g_usleep(reste / 1000);
+        else
+            echeance = Profil_debut();
     }
+    return NULL;
 }
 
-void fontaineVariable(Contexte *pCtxt,
-                      double p, double var,
-                      double x, double y, double vx, double vy, double m) {
+void publieTrame(Contexte *pCtxt) {
+    Trame *T = EchangeTrames_aEcrire(&pCtxt->trames);
     TabParticules *P = &pCtxt->TabP;
-    if ((rand() / (double) RAND_MAX) < p) {
-        Particule q;
-        double v1 = (rand() / (double) RAND_MAX) * var;
-        double v2 = (rand() / (double) RAND_MAX) * var;
-        initParticule(&q, x, y, vx - v1, vy + v2, m);
-        TabParticules_ajoute(P, q);
+    Trame_reserve(T, TabParticules_nb(P));
+    for (int i = 0; i < T->nb_particules; ++i) {
+        const Particule *p = TabParticules_ref(P, i);
+        T->particules[i].x = (float) p->x[0];
+        T->particules[i].y = (float) p->x[1];
+        T->particules[i].m = (float) p->m;
+        double v2 = 0.0;
+        for (int k = 0; k < DIM; ++k)
+            v2 += p->v[k] * p->v[k];
+        T->particules[i].v = (float) sqrt(v2);
     }
+    Trame_grille(T, pCtxt->domaine.bmin, pCtxt->domaine.bmax);
+    T->pas = pCtxt->pas;
+    T->nb_dormantes = TabParticules_nbDormantes(P);
+    TabObstacles_copie(&T->obstacles, &pCtxt->TabO);
+    TabObstacles_copie(&T->mobiles, &pCtxt->mobiles.O);
+    TabObstacles_copie(&T->murs, &pCtxt->murs);
+    T->selection = pCtxt->selection;
+    // L'interface cherche les obstacles visibles dans l'arbre.
+    Trame_copieArbre(T, Racine(pCtxt->index.kdtree), pCtxt->index.version);
+    strcpy(T->profil, pCtxt->resume);
+    EchangeTrames_publie(&pCtxt->trames);
+}
+
+void envoieCommande(Contexte *pCtxt, const Commande *c) {
+    while (!FileCommandes_envoie(&pCtxt->commandes, c))
+        g_usleep(1000);
 }
 
-gint tic(gpointer data) {
+void sdf_toggled_reaction(GtkToggleButton *bouton, gpointer data) {
     Contexte *pCtxt = (Contexte *) data;
-//    fontaine(pCtxt, 0.25, -0.5, 0.5, 0.3, 0.3, 2.5);
-    fontaineVariable(pCtxt, 0.2, 0.1, -0.5, 0.5, 0.3, 0.3, 1.0);
-    fontaineVariable(pCtxt, 0.25, 0.2, -0.5, 0.5, 0.3, 0.3, 0.5);
-    fontaineVariable(pCtxt, 0.6, 0.18, -0.5, 0.5, 0.3, 0.3, 2.5);
-    calculDynamique(pCtxt);
-    deplaceTout(pCtxt);
-    g_timeout_add(1000 * DT, tic, (gpointer) pCtxt); // réenclenche le timer.
-    return 0;
+    Commande c;
+    c.type = CMD_SDF;
+    c.actif = gtk_toggle_button_get_active(bouton);
+    envoieCommande(pCtxt, &c);
+}
+
+void vue_initiale_reaction(GtkButton *bouton, gpointer data) {
+    Contexte *pCtxt = (Contexte *) data;
+    pCtxt->vue.centre[0] = 0.0;
+    pCtxt->vue.centre[1] = 0.0;
+    pCtxt->vue.zoom = 1.0;
+    gtk_widget_queue_draw(pCtxt->drawing_area);
 }
 
 gint ticAffichage(gpointer data) {
     Contexte *pCtxt = (Contexte *) data;
     char buffer[128];
-    sprintf(buffer, "%d points", TabParticules_nb(&pCtxt->TabP));
+    sprintf(buffer, "%d points", EchangeTrames_derniere(&pCtxt->trames)->nb_particules);
     gtk_label_set_text(GTK_LABEL(pCtxt->label_nb), buffer);
     gtk_widget_queue_draw(pCtxt->drawing_area);
     g_timeout_add(1000 * DT_AFF, ticAffichage, (gpointer) pCtxt); // réenclenche le timer.
@@ -433,6 +1469,15 @@ gint ticDistance(gpointer data) {
     sprintf(buffer, "%7d nb appels à distance()", getCompteurDistance()),
             gtk_label_set_text(GTK_LABEL(pCtxt->label_distance), buffer);
     resetCompteurDistance();
+    // Les phases de la simulation viennent de la trame, l'affichage est
+    // mesuré ici (on saute la ligne d'en-tête de son résumé).
+    char texte[TRAME_TEXTE];
+    Profil_resume(&pCtxt->profil_affichage, texte, sizeof(texte));
+    const char *ligne = strchr(texte, '\n');
+    char *markup = g_markup_printf_escaped("<tt>%s%s</tt>", EchangeTrames_derniere(&pCtxt->trames)->profil,
+                                           ligne != NULL ? ligne : "");
+    gtk_label_set_markup(GTK_LABEL(pCtxt->label_profil), markup);
+    g_free(markup);
     g_timeout_add(1000, ticDistance, (gpointer) pCtxt); // réenclenche le timer.
     return 0;
 }
@@ -441,14 +1486,24 @@ void calculDynamique(Contexte *pCtxt) {
     TabParticules *P = &pCtxt->TabP;
     int n = TabParticules_nb(P);
     Force *F = pCtxt->forces;
+    // Si une force a changé, les particules au repos ne le sont plus.
+    for (int j = 0; j < NB_FORCES; ++j)
+        if (F[j].type != pCtxt->forces_avant[j].type
+            || F[j].params[0] != pCtxt->forces_avant[j].params[0]
+            || F[j].params[1] != pCtxt->forces_avant[j].params[1]) {
+            TabParticules_reveilleTout(P);
+            pCtxt->forces_avant[j] = F[j];
+        }
+    // Les particules dormantes ne sont pas simulées.
+    int d = TabParticules_nbDormantes(P);
     // On met à zéro les forces de chaque point.
-    for (int i = 0; i < n; ++i) {
+    for (int i = d; i < n; ++i) {
         Particule *p = TabParticules_ref(P, i);
-        p->f[0] = 0.0;
-        p->f[1] = 0.0;
+        for (int k = 0; k < DIM; ++k)
+            p->f[k] = 0.0;
     }
     // On applique les forces à tous les points
-    for (int i = 0; i < n; ++i) {
+    for (int i = d; i < n; ++i) {
         Particule *p = TabParticules_ref(P, i);
         for (int j = 0; j < NB_FORCES; ++j)
             appliqueForce(p, &F[j]);
@@ -456,110 +1511,316 @@ void calculDynamique(Contexte *pCtxt) {
     // On applique la loi de Newton: masse*acceleration = somme des forces
     // ie m dv/dt = sum f
     // ie v[t+dt] = v[t] + (dt/m) * sum f
-    for (int i = 0; i < n; ++i) {
+    for (int i = d; i < n; ++i) {
         Particule *p = TabParticules_ref(P, i);
-        p->v[0] += (DT / p->m) * p->f[0];
-        p->v[1] += (DT / p->m) * p->f[1];
-    }
-}
-
-// Cette fonction n'est appelé que si la particule p déplacée (p.x +
-// DT*p.v) est à l'intérieur du disque B_r(center).  Elle retourne
-// alors le rebond de la particule calculé pour cet obstacle circulaire
-// (nouveau x, nouveau v) en fonction de l'atténuation choisie.  En
-// sortie, la particule est en dehors de l'obstacle.
-Particule calculRebond(Particule p, Point center, double r, double att) {
-    Point xd, v;
-    // Calcule la nouvelle position xd (sans collision) et le vecteur vitesse.
-    xd.x[0] = p.x[0] + DT * p.v[0];
-    xd.x[1] = p.x[1] + DT * p.v[1];
-    v.x[0] = p.v[0];
-    v.x[1] = p.v[1];
-    Point u = Point_normalize(Point_sub(xd, center));
-    double l = Point_norm(Point_sub(xd, center));
-    Point xm = Point_add(center, Point_mul(r + att * (r - l), u));
-    double proj_v = Point_dot(v, u);
-    // réalise le rebond si la particule est bien en train de rentrer dans l'obstacle.
-    if (proj_v < 0.0)
-        v = Point_sub(v, Point_mul(2.0 * proj_v, u));
-    Particule p_out = p;
-    p_out.x[0] = xm.x[0];
-    p_out.x[1] = xm.x[1];
-    p_out.v[0] = att * v.x[0];
-    p_out.v[1] = att * v.x[1];
-    return p_out;
-}
-
-
-void deplaceParticule(Contexte *pCtxt, Particule *p) {
-    // Déplace p en supposant qu'il n'y a pas de collision.
-    Point pp;
-    pp.x[0] = p->x[0] + DT * p->v[0];
-    pp.x[1] = p->x[1] + DT * p->v[1];
-
-    TabObstacles F; // obstacles potentiels;
-    TabObstacles_init(&F);
-    KDT_PointsDansBoule(&F, Racine(pCtxt->kdtree), &pp, 0.05, 0);
+        for (int k = 0; k < DIM; ++k)
+            p->v[k] += (DT / p->m) * p->f[k];
+    }
+}
 
+void deplaceParticuleParmi(Particule *p, const SDF *S, TabObstacles *F) {
+    if (S != NULL && SDF_Rebond(S, p, DT))
+        return;
     bool collision = false;
     int i = 0;
-    while (!collision && i < TabObstacles_nb(&F)) {
-        Obstacle obs = TabObstacles_get(&F, i);
-        if (distance(p->x[0], p->x[1], obs.x[0], obs.x[1]) <= obs.r) {
+    while (!collision && i < TabObstacles_nb(F)) {
+        const Obstacle *obs = TabObstacles_ref(F, i);
+        if (Obstacle_touche(obs, p, DT)) {
             collision = true;
-            Point point;
-            point.x[0] = obs.x[0];
-            point.x[1] = obs.x[1];
-            *p = calculRebond(*p, point, obs.r, obs.att);
+            *p = calculRebond(*p, obs, DT);
         }
 
         i++;
     }
 
-    if (!collision) {
-        p->x[0] += DT * p->v[0];
-        p->x[1] += DT * p->v[1];
-    }
+    if (!collision)
+        for (int k = 0; k < DIM; ++k)
+            p->x[k] += DT * p->v[k];
+}
 
-    TabObstacles_termine(&F); // pour éviter les fuites mémoire.
+void reordonneParticules(Contexte *pCtxt) {
+    TabParticules *P = &pCtxt->TabP;
+    // Seules les particules actives sont réordonnées.
+    int d = TabParticules_nbDormantes(P);
+    int n = TabParticules_nb(P) - d;
+    const Domaine *D = &pCtxt->domaine;
+    uint32_t *cles = TriMorton_prepare(&pCtxt->tri, n);
+    for (int i = 0; i < n; ++i)
+        cles[i] = Morton_cle(TabParticules_ref(P, d + i)->x, D->bmin, D->bmax);
+    TabParticules_reordonne(P, TriMorton_trie(&pCtxt->tri), NULL);
 }
 
-void deplaceTout(Contexte *pCtxt) {
+void obstacleChange(Contexte *pCtxt, const Obstacle *o) {
+    SDF_Marque(&pCtxt->sdf, o);
     TabParticules *P = &pCtxt->TabP;
-    int n = TabParticules_nb(P);
-    // Applique le vecteur vitesse sur toutes les particules.
-    for (int i = 0; i < n; ++i) {
+    double bmin[DIM], bmax[DIM];
+    Obstacle_boite(o, bmin, bmax);
+    for (int i = 0; i < TabParticules_nbDormantes(P);) {
         Particule *p = TabParticules_ref(P, i);
-        deplaceParticule(pCtxt, p);
+        bool proche = true;
+        for (int a = 0; a < DIM; ++a)
+            proche = proche && p->x[a] >= bmin[a] - RAYON_CANDIDATS && p->x[a] <= bmax[a] + RAYON_CANDIDATS;
+        if (proche)
+            TabParticules_reveille(P, i); // la dernière dormante prend sa place
+        else ++i;
     }
-    // Détruit les particules trop loin de la zone
-    for (int i = 0; i < TabParticules_nb(P);) {
+}
+
+void reveilleParMobiles(Contexte *pCtxt) {
+    TabParticules *P = &pCtxt->TabP;
+    BVH *B = &pCtxt->mobiles.bvh;
+    if (B->nb_noeuds == 0)
+        return;
+    const NoeudBVH *racine = B->noeuds;
+    TabObstacles *F = &pCtxt->candidats[0];
+    for (int i = 0; i < TabParticules_nbDormantes(P);) {
         Particule *p = TabParticules_ref(P, i);
-        if ((p->x[0] < -1.5) || (p->x[0] > 1.5)
-            || (p->x[1] < -1.5) || (p->x[1] > 1.5))
-            TabParticules_supprime(P, i);
+        bool proche = true;
+        for (int a = 0; a < DIM; ++a)
+            proche = proche && p->x[a] >= racine->bmin[a] - RAYON_CANDIDATS
+                     && p->x[a] <= racine->bmax[a] + RAYON_CANDIDATS;
+        if (proche) {
+            Point pp;
+            for (int k = 0; k < DIM; ++k)
+                pp.x[k] = p->x[k];
+            TabObstacles_vide(F);
+            BVH_DansBoulePaquet(B, F, &pp, 1, RAYON_CANDIDATS, pp.x, pp.x);
+            proche = TabObstacles_nb(F) > 0;
+        }
+        if (proche)
+            TabParticules_reveille(P, i);
         else ++i;
     }
 }
 
+void deplaceTout(Contexte *pCtxt) {
+    TabParticules *P = &pCtxt->TabP;
+    Profil *prof = &pCtxt->profil;
+    int64_t t = Profil_debut();
+    reveilleParMobiles(pCtxt);
+    Profil_fin(prof, PHASE_RECHERCHE, t);
+    // Seules les particules actives, dans [d,d+n[, sont déplacées.
+    int d = TabParticules_nbDormantes(P);
+    int n = TabParticules_nb(P) - d;
+    // Trie les particules selon l'ordre en Z de leur position prédite,
+    // pour que chaque paquet regroupe des particules voisines.
+    const Domaine *D = &pCtxt->domaine;
+    uint32_t *cles = TriMorton_prepare(&pCtxt->tri, n);
+    for (int i = 0; i < n; ++i) {
+        Particule *p = TabParticules_ref(P, d + i);
+        Reel x[DIM];
+        for (int a = 0; a < DIM; ++a)
+            x[a] = p->x[a] + DT * p->v[a];
+        cles[i] = Morton_cle(x, D->bmin, D->bmax);
+    }
+    const int *ordre = TriMorton_trie(&pCtxt->tri);
+    // Avec le champ de distance, plus besoin de chercher les obstacles de TabO dans l'arbre.
+    const SDF *S = pCtxt->sdf.pret && pCtxt->sdf_actif ? &pCtxt->sdf : NULL;
+    // Applique le vecteur vitesse sur toutes les particules, paquet par
+    // paquet, les blocs de paquets étant répartis entre les fils. Chaque
+    // fil mesure ses phases; le temps écoulé est réparti entre elles au
+    // prorata.
+    Deplacement dep = {pCtxt, ordre, d, n, S};
+    int nb_fils = Ordonnanceur_nbFils(pCtxt->ordonnanceur);
+    for (int k = 0; k < nb_fils * NB_PHASES; ++k)
+        pCtxt->temps_fils[k] = 0;
+    t = Profil_debut();
+    Ordonnanceur_parallele(pCtxt->ordonnanceur, (n + KDT_PAQUET - 1) / KDT_PAQUET, PAQUETS_PAR_BLOC,
+                           deplacePaquets, &dep);
+    int64_t temps[NB_PHASES] = {0};
+    for (int k = 0; k < nb_fils * NB_PHASES; ++k)
+        temps[k % NB_PHASES] += pCtxt->temps_fils[k];
+    Profil_repartit(prof, t, temps);
+    // Détruit les particules sorties du domaine et endort celles qui sont
+    // lentes depuis PAS_SOMMEIL pas.
+    t = Profil_debut();
+    TabParticules_compacte(P, PAS_SOMMEIL);
+    Profil_fin(prof, PHASE_BORDS, t);
+}
+
+void deplacePaquets(void *arg, int debut, int fin) {
+    const Deplacement *dep = (const Deplacement *) arg;
+    Contexte *pCtxt = dep->pCtxt;
+    TabParticules *P = &pCtxt->TabP;
+    const Domaine *D = &pCtxt->domaine;
+    int f = Ordonnanceur_numero();
+    TabObstacles *F = pCtxt->candidats + f * KDT_PAQUET;
+    int64_t temps[NB_PHASES] = {0};
+    for (int paquet = debut; paquet < fin; ++paquet) {
+        int premier = paquet * KDT_PAQUET;
+        int k = dep->n - premier < KDT_PAQUET ? dep->n - premier : KDT_PAQUET;
+        int64_t t = Profil_debut();
+        Point pp[KDT_PAQUET];
+        Reel pmin[DIM], pmax[DIM];
+        for (int j = 0; j < k; ++j) {
+            Particule *p = TabParticules_ref(P, dep->d + dep->ordre[premier + j]);
+            for (int a = 0; a < DIM; ++a) {
+                pp[j].x[a] = p->x[a] + DT * p->v[a];
+                pmin[a] = j == 0 || pp[j].x[a] < pmin[a] ? pp[j].x[a] : pmin[a];
+                pmax[a] = j == 0 || pp[j].x[a] > pmax[a] ? pp[j].x[a] : pmax[a];
+            }
+            TabObstacles_vide(&F[j]);
+        }
+        if (dep->S == NULL)
+            KDT_DansBoulePaquetObstacles(F, pCtxt->TabO.obstacles, Racine(pCtxt->index.kdtree),
+                                         pp, k, RAYON_CANDIDATS + pCtxt->index.r_max, pmin, pmax, 0);
+        BVH_DansBoulePaquet(&pCtxt->mobiles.bvh, F, pp, k, RAYON_CANDIDATS, pmin, pmax);
+        BVH_DansBoulePaquet(&pCtxt->bvh_murs, F, pp, k, RAYON_CANDIDATS, pmin, pmax);
+        int64_t t2 = Profil_debut();
+        temps[PHASE_RECHERCHE] += t2 - t;
+        for (int j = 0; j < k; ++j)
+            deplaceParticuleParmi(TabParticules_ref(P, dep->d + dep->ordre[premier + j]), dep->S, &F[j]);
+        t = Profil_debut();
+        temps[PHASE_COLLISIONS] += t - t2;
+        // Tant que le paquet est en cache, on applique les bords du domaine
+        // et on compte les pas lents; le tri se fait après, en un seul parcours.
+        for (int j = 0; j < k; ++j) {
+            Particule *p = TabParticules_ref(P, dep->d + dep->ordre[premier + j]);
+            if (!Domaine_applique(D, p))
+                p->calme = -1;
+            else {
+                double v2 = 0.0;
+                for (int a = 0; a < DIM; ++a)
+                    v2 += p->v[a] * p->v[a];
+                bool lente = v2 < VITESSE_SOMMEIL * VITESSE_SOMMEIL;
+                p->calme = lente ? p->calme + 1 : 0;
+            }
+        }
+        temps[PHASE_BORDS] += Profil_debut() - t;
+    }
+    for (int ph = 0; ph < NB_PHASES; ++ph)
+        pCtxt->temps_fils[f * NB_PHASES + ph] += temps[ph];
+    reporteCompteurDistance();
+}
+
+void appliqueCommande(Contexte *pCtxt, const Commande *c) {
+    if (c->type == CMD_SDF) {
+        pCtxt->sdf_actif = c->actif;
+        return;
+    }
+    if (c->type == CMD_LACHE) {
+        pCtxt->glisse = false;
+        return;
+    }
+    if (c->type == CMD_GLISSE) {
+        if (!pCtxt->glisse || pCtxt->selection < 0)
+            return;
+        obstacleChange(pCtxt, TabObstacles_ref(&pCtxt->TabO, pCtxt->selection));
+        IndexObstacles_deplace(&pCtxt->index, pCtxt->selection, c->p);
+        obstacleChange(pCtxt, TabObstacles_ref(&pCtxt->TabO, pCtxt->selection));
+        return;
+    }
+
+    Obstacle o;
+    Point p = c->p;
+    int i = obstacleSousPoint(pCtxt, p, c->rayon);
+
+    if (c->bouton == 3) {
+        // Supprime l'obstacle sous la souris. Le dernier obstacle prend son indice.
+        if (i < 0) return;
+        int dernier = TabObstacles_nb(&pCtxt->TabO) - 1;
+        obstacleChange(pCtxt, TabObstacles_ref(&pCtxt->TabO, i));
+        IndexObstacles_supprime(&pCtxt->index, i);
+        if (pCtxt->selection == i)
+            pCtxt->selection = -1;
+        else if (pCtxt->selection == dernier)
+            pCtxt->selection = i;
+        pCtxt->glisse = false;
+        return;
+    }
+    if (c->bouton != 1) return;
+
+    if (i < 0) {
+        initObstacle(&o, DISQUE, p.x[0], p.x[1], 0.05, c->force, 0, 0, 0);
+        i = IndexObstacles_ajoute(&pCtxt->index, o);
+        obstacleChange(pCtxt, &o);
+    }
+    pCtxt->selection = i;
+    pCtxt->glisse = true;
+}
+
 gboolean mouse_clic_reaction(GtkWidget *widget, GdkEventButton *event, gpointer data) {
     Contexte *pCtxt = (Contexte *) data;
-    int button = event->button; // 1 is left button
-    if (button != 1) return TRUE;
-    int x = event->x;
-    int y = event->y;
+    if (event->button == 2) {
+        pCtxt->ancre[0] = event->x;
+        pCtxt->ancre[1] = event->y;
+        return TRUE;
+    }
+    Commande c;
+    c.type = CMD_CLIC;
+    c.bouton = event->button; // 1 is left button, 3 is right button
+    c.p.x[0] = event->x;
+    c.p.x[1] = event->y;
+    c.p = drawingAreaPoint2Point(pCtxt, c.p);
+    c.force = gtk_range_get_value((GtkRange *) pCtxt->force_obstacle);
+    c.rayon = RAYON_OBSTACLE_AFF / length2DrawingAreaLength(pCtxt, 1.0);
+    envoieCommande(pCtxt, &c);
+    return TRUE;
+}
 
-    Obstacle o;
-    Point p;
-    p.x[0] = x;
-    p.x[1] = y;
-    p = drawingAreaPoint2Point(pCtxt, p);
+gboolean mouse_move_reaction(GtkWidget *widget, GdkEventMotion *event, gpointer data) {
+    Contexte *pCtxt = (Contexte *) data;
+    int x, y;
+    unsigned state;
+    // Avec GDK_POINTER_MOTION_HINT_MASK, il faut redemander la position
+    // pour recevoir l'événement suivant.
+    gdk_window_get_pointer(event->window, &x, &y, &state);
+    if (state & GDK_BUTTON2_MASK) {
+        // Le point sous la souris suit la souris.
+        double echelle = length2DrawingAreaLength(pCtxt, 1.0);
+        pCtxt->vue.centre[0] -= (x - pCtxt->ancre[0]) / echelle;
+        pCtxt->vue.centre[1] += (y - pCtxt->ancre[1]) / echelle;
+        pCtxt->ancre[0] = x;
+        pCtxt->ancre[1] = y;
+        gtk_widget_queue_draw(pCtxt->drawing_area);
+        return TRUE;
+    }
+    if (!(state & GDK_BUTTON1_MASK))
+        return TRUE;
+    Commande c;
+    c.type = CMD_GLISSE;
+    c.p.x[0] = x;
+    c.p.x[1] = y;
+    c.p = drawingAreaPoint2Point(pCtxt, c.p);
+    envoieCommande(pCtxt, &c);
+    return TRUE;
+}
 
-    double force = gtk_range_get_value((GtkRange *) pCtxt->force_obstacle);
-    initObstacle(&o, DISQUE, p.x[0], p.x[1], 0.05, force, 0, 0, 0);
-    TabObstacles_ajoute(&pCtxt->TabO, o);
-    Detruire(pCtxt->kdtree);
-    pCtxt->kdtree = KDT_Creer(pCtxt->TabO.obstacles, 0, TabObstacles_nb(&pCtxt->TabO) - 1, 0);
+gboolean mouse_scroll_reaction(GtkWidget *widget, GdkEventScroll *event, gpointer data) {
+    Contexte *pCtxt = (Contexte *) data;
+    double facteur;
+    if (event->direction == GDK_SCROLL_UP)
+        facteur = ZOOM_PAS;
+    else if (event->direction == GDK_SCROLL_DOWN)
+        facteur = 1.0 / ZOOM_PAS;
+    else
+        return TRUE;
+    double zoom = fmin(fmax(pCtxt->vue.zoom * facteur, ZOOM_MIN), ZOOM_MAX);
+    // Le point sous la souris reste sous la souris.
+    Point souris = {{event->x, event->y}};
+    Point p = drawingAreaPoint2Point(pCtxt, souris);
+    double r = pCtxt->vue.zoom / zoom;
+    for (int a = 0; a < 2; ++a)
+        pCtxt->vue.centre[a] = p.x[a] + (pCtxt->vue.centre[a] - p.x[a]) * r;
+    pCtxt->vue.zoom = zoom;
+    gtk_widget_queue_draw(pCtxt->drawing_area);
+    return TRUE;
+}
 
+gboolean mouse_release_reaction(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+    Contexte *pCtxt = (Contexte *) data;
+    if (event->button == 1) {
+        Commande c;
+        c.type = CMD_LACHE;
+        envoieCommande(pCtxt, &c);
+    }
     return TRUE;
 }
+
+int obstacleSousPoint(Contexte *pCtxt, Point p, double r_dessin) {
+    double d;
+    int i = IndexObstacles_plusProche(&pCtxt->index, &p, &d);
+    if (i < 0 || d > fmax(TabObstacles_ref(&pCtxt->TabO, i)->r, r_dessin))
+        return -1;
+    return i;
+}
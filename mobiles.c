@@ -0,0 +1,77 @@
+#include <math.h>
+#include "mobiles.h"
+#include "tableau.h"
+
+void Mobiles_init(Mobiles *M) {
+    TabObstacles_init(&M->O);
+    M->mvt = NULL;
+    M->taille_mvt = 0;
+    BVH_init(&M->bvh, &M->O);
+    M->t = 0.0;
+}
+
+// Place l'obstacle o selon le mouvement m au temps t, et calcule sa vitesse.
+static void place(Obstacle *o, const Mouvement *m, double t) {
+    double c = cos(m->omega * t), s = sin(m->omega * t);
+    switch (m->type) {
+        case OSCILLE:
+            for (int k = 0; k < DIM; ++k) {
+                o->x[k] = m->c[k] + s * m->a[k];
+                o->v[k] = m->omega * c * m->a[k];
+            }
+            break;
+        case TOURNE: {
+            // La rotation se fait dans le plan des deux premiers axes.
+            for (int k = 2; k < DIM; ++k) {
+                o->x[k] = m->c[k] + m->a[k];
+                o->v[k] = 0.0;
+            }
+            double rx = c * m->a[0] - s * m->a[1];
+            double ry = s * m->a[0] + c * m->a[1];
+            o->x[0] = m->c[0] + rx;
+            o->x[1] = m->c[1] + ry;
+            o->v[0] = -m->omega * ry;
+            o->v[1] = m->omega * rx;
+            break;
+        }
+    }
+}
+
+void Mobiles_ajoute(Mobiles *M, Obstacle o, Mouvement mvt) {
+    place(&o, &mvt, M->t);
+    TabObstacles_ajoute(&M->O, o);
+    int n = TabObstacles_nb(&M->O);
+    if (n > M->taille_mvt)
+        M->mvt = Tableau_agrandir(M->mvt, &M->taille_mvt, n - 1, sizeof(Mouvement));
+    M->mvt[n - 1] = mvt;
+}
+
+void Mobiles_copie(Mobiles *dst, const Mobiles *src) {
+    int n = src->O.nb;
+    TabObstacles_copie(&dst->O, &src->O);
+    dst->mvt = Tableau_reserve(dst->mvt, &dst->taille_mvt, 0, n, sizeof(Mouvement));
+    for (int i = 0; i < n; ++i)
+        dst->mvt[i] = src->mvt[i];
+    dst->t = src->t;
+    BVH_Construit(&dst->bvh);
+}
+
+int Mobiles_nb(Mobiles *M) {
+    return TabObstacles_nb(&M->O);
+}
+
+void Mobiles_avance(Mobiles *M, double dt) {
+    M->t += dt;
+    int n = TabObstacles_nb(&M->O);
+    if (n == 0) return;
+    for (int i = 0; i < n; ++i)
+        place(TabObstacles_ref(&M->O, i), M->mvt + i, M->t);
+    BVH_Reajuste(&M->bvh);
+}
+
+void Mobiles_termine(Mobiles *M) {
+    BVH_termine(&M->bvh);
+    Tableau_libere(M->mvt, &M->taille_mvt, sizeof(Mouvement));
+    M->mvt = NULL;
+    TabObstacles_termine(&M->O);
+}
@@ -0,0 +1,60 @@
+#ifndef _MOBILES_H_
+#define _MOBILES_H_
+
+#include "points.h"
+#include "obstacles.h"
+#include "bvh.h"
+
+/// Les mouvements imposés possibles pour un obstacle mobile.
+typedef enum {
+    OSCILLE, //< va-et-vient (piston): x(t) = c + sin(omega t) a
+    TOURNE   //< rotation autour d'un pivot (palette): x(t) = c + R(omega t) a
+} MouvementType;
+
+/// Le mouvement imposé à un obstacle mobile (obstacle cinématique).
+typedef struct SMouvement {
+    MouvementType type;
+    double c[DIM];  //< centre de l'oscillation, ou pivot de la rotation
+    double a[DIM];  //< amplitude de l'oscillation, ou position initiale relative au pivot
+    double omega;   //< pulsation ou vitesse angulaire, en rad/s
+} Mouvement;
+
+/**
+   Les obstacles mobiles: des obstacles dont la position est imposée en
+   fonction du temps. Ils ne sont pas dans l'arbre k-D des obstacles
+   fixes, mais dans une hiérarchie de volumes englobants qui est
+   simplement réajustée à chaque pas de temps.
+*/
+typedef struct SMobiles {
+    TabObstacles O;   //< les obstacles, à leur position et vitesse courantes
+    Mouvement *mvt;   //< mvt[i] est le mouvement de l'obstacle i
+    int taille_mvt;
+    BVH bvh;
+    double t;         //< temps courant
+} Mobiles;
+
+/// Initialise un ensemble vide d'obstacles mobiles.
+void Mobiles_init(Mobiles *M);
+
+/**
+   Ajoute l'obstacle \a o, animé par le mouvement \a mvt. La position
+   de \a o est ignorée: elle est donnée par le mouvement.
+*/
+void Mobiles_ajoute(Mobiles *M, Obstacle o, Mouvement mvt);
+
+/// Remplace \a dst (initialisé) par une copie de \a src, avec sa propre hiérarchie.
+void Mobiles_copie(Mobiles *dst, const Mobiles *src);
+
+/// @return le nombre d'obstacles mobiles.
+int Mobiles_nb(Mobiles *M);
+
+/**
+   Avance le temps de \a dt: met à jour la position et la vitesse de
+   chaque obstacle mobile, puis réajuste la hiérarchie en O(n).
+*/
+void Mobiles_avance(Mobiles *M, double dt);
+
+/// Libère la mémoire des obstacles mobiles.
+void Mobiles_termine(Mobiles *M);
+
+#endif
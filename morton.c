@@ -0,0 +1,94 @@
+#include <string.h>
+#include "morton.h"
+#include "tableau.h"
+
+// Nombre de bits par coordonnée: 16 en 2D, 10 en 3D.
+#define MORTON_BITS (32 / DIM)
+
+// Écarte les MORTON_BITS bits de poids faible de v: le bit k passe en position DIM*k.
+static uint32_t ecarte(uint32_t v) {
+#if DIM == 2
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+#else
+    v &= 0x000003ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+#endif
+    return v;
+}
+
+uint32_t Morton_cle(const Reel x[DIM], const double bmin[DIM], const double bmax[DIM]) {
+    uint32_t cle = 0;
+    for (int k = 0; k < DIM; ++k) {
+        double t = (x[k] - bmin[k]) / (bmax[k] - bmin[k]);
+        if (!(t > 0.0)) t = 0.0; // attrape aussi NaN
+        if (t > 1.0) t = 1.0;
+        cle |= ecarte((uint32_t) (t * ((1u << MORTON_BITS) - 1))) << k;
+    }
+    return cle;
+}
+
+// Les quatre tampons partagent la capacité t->taille. Leur contenu n'a
+// pas besoin d'être conservé quand on les agrandit.
+static void *retaille(void *data, int taille, int n, size_t elem) {
+    return Tableau_redimensionne(data, &taille, 0, n, elem);
+}
+
+void TriMorton_init(TriMorton *t) {
+    t->taille = 0;
+    t->nb = 0;
+    t->cles = t->cles2 = NULL;
+    t->indices = t->indices2 = NULL;
+}
+
+uint32_t *TriMorton_prepare(TriMorton *t, int n) {
+    if (n > t->taille) {
+        t->cles = retaille(t->cles, t->taille, n, sizeof(uint32_t));
+        t->cles2 = retaille(t->cles2, t->taille, n, sizeof(uint32_t));
+        t->indices = retaille(t->indices, t->taille, n, sizeof(int));
+        t->indices2 = retaille(t->indices2, t->taille, n, sizeof(int));
+        t->taille = n;
+    }
+    t->nb = n;
+    return t->cles;
+}
+
+const int *TriMorton_trie(TriMorton *t) {
+    int n = t->nb;
+    uint32_t *cles = t->cles, *cles2 = t->cles2;
+    int *ind = t->indices, *ind2 = t->indices2;
+    for (int i = 0; i < n; ++i)
+        ind[i] = i;
+    for (int passe = 0; passe < 4; ++passe) {
+        int decalage = 8 * passe;
+        int compte[257];
+        memset(compte, 0, sizeof(compte));
+        for (int i = 0; i < n; ++i)
+            ++compte[((cles[i] >> decalage) & 0xff) + 1];
+        for (int b = 0; b < 256; ++b)
+            compte[b + 1] += compte[b];
+        for (int i = 0; i < n; ++i) {
+            int d = compte[(cles[i] >> decalage) & 0xff]++;
+            cles2[d] = cles[i];
+            ind2[d] = ind[i];
+        }
+        uint32_t *tc = cles; cles = cles2; cles2 = tc;
+        int *ti = ind; ind = ind2; ind2 = ti;
+    }
+    // Nombre pair de passes: les résultats sont revenus dans t->cles et t->indices.
+    return t->indices;
+}
+
+void TriMorton_termine(TriMorton *t) {
+    retaille(t->cles, t->taille, 0, sizeof(uint32_t));
+    retaille(t->cles2, t->taille, 0, sizeof(uint32_t));
+    retaille(t->indices, t->taille, 0, sizeof(int));
+    retaille(t->indices2, t->taille, 0, sizeof(int));
+    TriMorton_init(t);
+}
@@ -0,0 +1,56 @@
+#ifndef _MORTON_H_
+#define _MORTON_H_
+
+#include <stdint.h>
+#include "points.h"
+
+/**
+   Calcule la clé de Morton (ordre en Z) du point \a x dans la boîte
+   [bmin,bmax]: les bits des coordonnées discrétisées sont entrelacés,
+   si bien que deux points proches dans le plan ont en général des clés
+   proches. Les points hors de la boîte sont ramenés sur son bord.
+
+   @param x les coordonnées du point.
+   @param bmin le coin inférieur de la boîte.
+   @param bmax le coin supérieur de la boîte.
+   @return une clé sur 32 bits.
+*/
+uint32_t Morton_cle(const Reel x[DIM], const double bmin[DIM], const double bmax[DIM]);
+
+/**
+   Trie des indices selon des clés de Morton, par un tri par base (radix
+   sort) stable, en 4 passes de 8 bits. Les tampons sont gardés d'un tri
+   à l'autre pour ne pas réallouer à chaque pas de temps.
+*/
+typedef struct STriMorton {
+    int taille;          //< capacité des tampons
+    int nb;              //< nombre de clés à trier
+    uint32_t *cles;      //< les clés, à remplir par l'appelant
+    int *indices;        //< après le tri: les indices dans l'ordre des clés
+    uint32_t *cles2;     //< tampon
+    int *indices2;       //< tampon
+} TriMorton;
+
+/// Initialise un tri vide.
+void TriMorton_init(TriMorton *t);
+
+/**
+   Prépare le tri de \a n clés.
+
+   @return le tableau des \a n clés, que l'appelant doit remplir (la clé
+   i est celle de l'élément d'indice i).
+*/
+uint32_t *TriMorton_prepare(TriMorton *t, int n);
+
+/**
+   Trie les clés remplies après TriMorton_prepare.
+
+   @return les indices 0..n-1 réordonnés par clés croissantes (les
+   égalités gardent l'ordre initial). Valide jusqu'au prochain appel.
+*/
+const int *TriMorton_trie(TriMorton *t);
+
+/// Libère les tampons du tri.
+void TriMorton_termine(TriMorton *t);
+
+#endif
@@ -1,11 +1,16 @@
+#include <math.h>
+#include <string.h>
 #include "obstacles.h"
+#include "tableau.h"
 
 
 void initObstacle(Obstacle *o, ObstacleType type, double x, double y, double rayon, double att,
                   double cr, double cg, double cb) {
     o->type = type;
-    o->x[0] = x;
-    o->x[1] = y;
+    for (int k = 0; k < DIM; ++k)
+        o->x[k] = o->x2[k] = o->v[k] = 0.0;
+    o->x[0] = o->x2[0] = x;
+    o->x[1] = o->x2[1] = y;
     o->r = rayon;
     o->att = att;
     o->cr = cr;
@@ -13,10 +18,33 @@ void initObstacle(Obstacle *o, ObstacleType type, double x, double y, double ray
     o->cb = cb;
 }
 
+void initObstacleEtendu(Obstacle *o, ObstacleType type, double x1, double y1, double x2, double y2,
+                        double rayon, double att, double cr, double cg, double cb) {
+    initObstacle(o, type, x1, y1, rayon, att, cr, cg, cb);
+    o->x2[0] = x2;
+    o->x2[1] = y2;
+    if (type == BOITE)
+        for (int k = 0; k < DIM; ++k) {
+            double a = fmin(o->x[k], o->x2[k]), b = fmax(o->x[k], o->x2[k]);
+            o->x[k] = a;
+            o->x2[k] = b;
+        }
+}
+
+void Obstacle_boite(const Obstacle *o, double bmin[DIM], double bmax[DIM]) {
+    double r = o->type == DISQUE || o->type == CAPSULE ? o->r : 0.0;
+    // Un disque n'a que son centre x (x2 n'est pas tenu à jour quand il bouge).
+    const Reel *x2 = o->type == DISQUE ? o->x : o->x2;
+    for (int k = 0; k < DIM; ++k) {
+        bmin[k] = fmin(o->x[k], x2[k]) - r;
+        bmax[k] = fmax(o->x[k], x2[k]) + r;
+    }
+}
+
 void TabObstacles_init(TabObstacles *tab) {
-    tab->taille = 10;
+    tab->taille = 0;
     tab->nb = 0;
-    tab->obstacles = (Obstacle *) malloc(tab->taille * sizeof(Obstacle));
+    tab->obstacles = NULL;
 }
 
 void TabObstacles_ajoute(TabObstacles *tab, Obstacle p) {
@@ -41,23 +69,42 @@ int TabObstacles_nb(TabObstacles *tab) {
 }
 
 void TabObstacles_termine(TabObstacles *tab) {
-    if (tab->obstacles != NULL) free(tab->obstacles);
-    tab->taille = 0;
+    Tableau_libere(tab->obstacles, &tab->taille, sizeof(Obstacle));
     tab->nb = 0;
     tab->obstacles = NULL;
 }
 
+void TabObstacles_supprime(TabObstacles *tab, int i) {
+    assert (i >= 0);
+    assert (i < tab->nb);
+    tab->obstacles[i] = tab->obstacles[--tab->nb];
+}
+
+void TabObstacles_vide(TabObstacles *tab) {
+    tab->nb = 0;
+}
+
 Obstacle *TabObstacles_ref(TabObstacles *tab, int i) {
     assert (i < tab->nb);
     return tab->obstacles + i;
 }
 
+void TabObstacles_copie(TabObstacles *dst, const TabObstacles *src) {
+    dst->nb = 0;
+    TabObstacles_reserve(dst, src->nb);
+    if (src->nb > 0)
+        memcpy(dst->obstacles, src->obstacles, src->nb * sizeof(Obstacle));
+    dst->nb = src->nb;
+}
+
+void TabObstacles_reserve(TabObstacles *tab, int n) {
+    tab->obstacles = Tableau_reserve(tab->obstacles, &tab->taille, tab->nb, n, sizeof(Obstacle));
+}
+
+void TabObstacles_ajuste(TabObstacles *tab) {
+    tab->obstacles = Tableau_ajuste(tab->obstacles, &tab->taille, tab->nb, sizeof(Obstacle));
+}
+
 void TabObstacles_agrandir(TabObstacles *tab) {
-    int new_taille = 2 * tab->taille;
-    Obstacle *new_pts = (Obstacle *) malloc(new_taille * sizeof(Obstacle));
-    for (int i = 0; i < tab->nb; ++i)
-        new_pts[i] = tab->obstacles[i];
-    free(tab->obstacles);
-    tab->obstacles = new_pts;
-    tab->taille = new_taille;
+    tab->obstacles = Tableau_agrandir(tab->obstacles, &tab->taille, tab->nb, sizeof(Obstacle));
 }
\ No newline at end of file
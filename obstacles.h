@@ -6,20 +6,33 @@
 #include "points.h"
 
 typedef enum {
-    DISQUE
+    DISQUE,  //< disque (boule en 3D) de centre x et de rayon r
+    SEGMENT, //< mur sans épaisseur de x à x2: les particules rebondissent en le traversant (en 2D seulement)
+    CAPSULE, //< ensemble des points à distance au plus r du segment [x,x2]
+    BOITE    //< rectangle aux côtés parallèles aux axes, de coin inférieur x et de coin supérieur x2
 } ObstacleType;
 
 typedef struct SObstacle {
-    ObstacleType type; //< Le type de l'obstacle. Ici on aura juste des DISQUEs.
-    double x[DIM];     //< Les coordonnées du centre de l'obstacle.
-    double r;          //< Le rayon de l'obstacle
-    double att;        //< le facteur d'atténuation de l'obstacle (0.0 amortisseur parfait, 1.0 rebondisseur parfait, 3.0 "bumper" comme dans un flipper.)
-    double cr, cg, cb; //< couleurs rgb de l'obstacle.
+    ObstacleType type; //< Le type de l'obstacle.
+    Reel x[DIM];       //< Les coordonnées du centre de l'obstacle (ou de son premier point).
+    Reel x2[DIM];      //< Le second point (SEGMENT, CAPSULE, BOITE). Égal à x pour un DISQUE.
+    Reel v[DIM];       //< La vitesse de l'obstacle (nulle sauf pour les obstacles mobiles).
+    Reel r;            //< Le rayon de l'obstacle
+    Reel att;          //< le facteur d'atténuation de l'obstacle (0.0 amortisseur parfait, 1.0 rebondisseur parfait, 3.0 "bumper" comme dans un flipper.)
+    Reel cr, cg, cb;   //< couleurs rgb de l'obstacle.
 } Obstacle;
 
 void initObstacle(Obstacle *o, ObstacleType type, double x, double y, double rayon, double att,
                   double cr, double cg, double cb);
 
+/// Initialise un obstacle étendu (SEGMENT, CAPSULE ou BOITE) défini par les points (x1,y1) et (x2,y2).
+/// En 3D, les autres coordonnées de l'obstacle sont nulles, comme pour initObstacle.
+void initObstacleEtendu(Obstacle *o, ObstacleType type, double x1, double y1, double x2, double y2,
+                        double rayon, double att, double cr, double cg, double cb);
+
+/// Calcule la boîte englobante [bmin,bmax] de l'obstacle \a o.
+void Obstacle_boite(const Obstacle *o, double bmin[DIM], double bmax[DIM]);
+
 typedef struct STabObstacle {
     int taille;
     int nb;
@@ -38,8 +51,21 @@ int TabObstacles_nb(TabObstacles *tab);
 
 void TabObstacles_termine(TabObstacles *tab);
 
+/// Supprime l'obstacle \a i du tableau. Le dernier obstacle prend sa place.
+void TabObstacles_supprime(TabObstacles *tab, int i);
+
+/// Retire tous les obstacles du tableau, mais garde sa mémoire pour le réutiliser.
+void TabObstacles_vide(TabObstacles *tab);
+
 Obstacle *TabObstacles_ref(TabObstacles *tab, int i);
 
+/// Remplace le contenu de \a dst par une copie de celui de \a src.
+void TabObstacles_copie(TabObstacles *dst, const TabObstacles *src);
+
+void TabObstacles_reserve(TabObstacles *tab, int n);
+
+void TabObstacles_ajuste(TabObstacles *tab);
+
 void TabObstacles_agrandir(TabObstacles *tab);
 
 
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200112L // pour sysconf(_SC_NPROCESSORS_ONLN)
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include "ordonnanceur.h"
+#include "tableau.h"
+
+// Le numéro du fil courant dans son ordonnanceur (0 pour le fil principal).
+static __thread int numero_fil = 0;
+
+static void initFile(FileTaches *F, Ordonnanceur *O, int numero) {
+    pthread_mutex_init(&F->verrou, NULL);
+    F->taille = 0;
+    F->haut = 0;
+    F->bas = 0;
+    F->taches = NULL;
+    F->O = O;
+    F->numero = numero;
+}
+
+// Ajoute la tâche t en bas de la file F.
+static void empile(FileTaches *F, Tache t) {
+    pthread_mutex_lock(&F->verrou);
+    int nb = F->bas - F->haut;
+    if (nb == F->taille) {
+        // L'anneau est plein: on le recopie dans l'ordre dans un plus grand.
+        int taille = 0;
+        Tache *T = Tableau_reserve(NULL, &taille, 0, nb < TABLEAU_TAILLE_MIN ? TABLEAU_TAILLE_MIN : 2 * nb,
+                                   sizeof(Tache));
+        for (int k = 0; k < nb; ++k)
+            T[k] = F->taches[(F->haut + k) % F->taille];
+        Tableau_libere(F->taches, &F->taille, sizeof(Tache));
+        F->taches = T;
+        F->taille = taille;
+        F->haut = 0;
+        F->bas = nb;
+    }
+    F->taches[F->bas++ % F->taille] = t;
+    pthread_mutex_unlock(&F->verrou);
+}
+
+// Retire une tâche de la file F, par le bas (propriétaire) ou par le
+// haut (voleur). Retourne 0 si la file est vide.
+static int retire(FileTaches *F, int par_le_bas, Tache *t) {
+    pthread_mutex_lock(&F->verrou);
+    int ok = F->bas > F->haut;
+    if (ok) {
+        *t = par_le_bas ? F->taches[--F->bas % F->taille] : F->taches[F->haut++ % F->taille];
+        if (F->bas == F->haut)
+            F->haut = F->bas = 0;
+    }
+    pthread_mutex_unlock(&F->verrou);
+    return ok;
+}
+
+// Prend une tâche pour le fil k: dans sa file d'abord, puis chez les
+// autres fils, en commençant par son voisin.
+static int prendTache(Ordonnanceur *O, int k, Tache *t) {
+    if (__atomic_load_n(&O->en_attente, __ATOMIC_SEQ_CST) == 0)
+        return 0;
+    int ok = retire(&O->files[k], 1, t);
+    for (int v = 1; !ok && v < O->nb_fils; ++v)
+        ok = retire(&O->files[(k + v) % O->nb_fils], 0, t);
+    if (ok)
+        __atomic_fetch_sub(&O->en_attente, 1, __ATOMIC_SEQ_CST);
+    return ok;
+}
+
+static void execute(Tache *t) {
+    t->f(t->arg);
+    __atomic_fetch_sub(&t->groupe->restantes, 1, __ATOMIC_RELEASE);
+}
+
+static void *boucleFil(void *arg) {
+    FileTaches *F = (FileTaches *) arg;
+    Ordonnanceur *O = F->O;
+    numero_fil = F->numero;
+    for (;;) {
+        Tache t;
+        if (prendTache(O, numero_fil, &t)) {
+            execute(&t);
+            continue;
+        }
+        // Rien à faire: on dort jusqu'au prochain lancement. Comme
+        // Ordonnanceur_lance compte la tâche avant de regarder s'il y a des
+        // endormis, et qu'on se compte endormi avant de regarder les
+        // tâches, l'un des deux voit toujours l'autre.
+        pthread_mutex_lock(&O->verrou);
+        __atomic_fetch_add(&O->endormis, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&O->en_attente, __ATOMIC_SEQ_CST) == 0 && !O->fin)
+            pthread_cond_wait(&O->reveil, &O->verrou);
+        __atomic_fetch_sub(&O->endormis, 1, __ATOMIC_SEQ_CST);
+        int fin = O->fin;
+        pthread_mutex_unlock(&O->verrou);
+        if (fin)
+            return NULL;
+    }
+}
+
+void Ordonnanceur_init(Ordonnanceur *O, int nb_fils) {
+    if (nb_fils <= 0)
+        nb_fils += (int) sysconf(_SC_NPROCESSORS_ONLN);
+    O->nb_fils = nb_fils > 0 ? nb_fils : 1;
+    O->files = (FileTaches *) malloc(O->nb_fils * sizeof(FileTaches));
+    O->fils = (pthread_t *) malloc(O->nb_fils * sizeof(pthread_t));
+    pthread_mutex_init(&O->verrou, NULL);
+    pthread_cond_init(&O->reveil, NULL);
+    O->en_attente = 0;
+    O->endormis = 0;
+    O->fin = 0;
+    for (int k = 0; k < O->nb_fils; ++k)
+        initFile(&O->files[k], O, k);
+    numero_fil = 0;
+    for (int k = 1; k < O->nb_fils; ++k)
+        pthread_create(&O->fils[k], NULL, boucleFil, &O->files[k]);
+}
+
+int Ordonnanceur_nbFils(const Ordonnanceur *O) {
+    return O->nb_fils;
+}
+
+int Ordonnanceur_numero(void) {
+    return numero_fil;
+}
+
+void GroupeTaches_init(GroupeTaches *G) {
+    G->restantes = 0;
+}
+
+void Ordonnanceur_lance(Ordonnanceur *O, GroupeTaches *G, FonctionTache f, void *arg) {
+    Tache t = {f, arg, G};
+    __atomic_fetch_add(&G->restantes, 1, __ATOMIC_RELAXED);
+    if (O->nb_fils == 1) {
+        execute(&t);
+        return;
+    }
+    // La tâche est comptée avant d'être empilée: en_attente ne passe
+    // jamais sous le nombre de tâches réellement dans les files.
+    __atomic_fetch_add(&O->en_attente, 1, __ATOMIC_SEQ_CST);
+    empile(&O->files[numero_fil], t);
+    if (__atomic_load_n(&O->endormis, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&O->verrou);
+        pthread_cond_signal(&O->reveil);
+        pthread_mutex_unlock(&O->verrou);
+    }
+}
+
+void Ordonnanceur_attend(Ordonnanceur *O, GroupeTaches *G) {
+    while (__atomic_load_n(&G->restantes, __ATOMIC_ACQUIRE) > 0) {
+        Tache t;
+        if (prendTache(O, numero_fil, &t))
+            execute(&t);
+        else
+            sched_yield(); // nos tâches sont en cours sur d'autres fils
+    }
+}
+
+/// Un morceau d'intervalle à traiter par Ordonnanceur_parallele.
+typedef struct SIntervalle {
+    Ordonnanceur *O;
+    FonctionBloc f;
+    void *arg;
+    int debut;
+    int fin;
+    int grain;
+} Intervalle;
+
+static void coupe(void *arg) {
+    Intervalle *I = (Intervalle *) arg;
+    if (I->fin - I->debut <= I->grain) {
+        I->f(I->arg, I->debut, I->fin);
+        return;
+    }
+    // La moitié droite est offerte aux voleurs, on traite la gauche.
+    int milieu = I->debut + (I->fin - I->debut) / 2;
+    Intervalle gauche = *I, droite = *I;
+    gauche.fin = milieu;
+    droite.debut = milieu;
+    GroupeTaches G;
+    GroupeTaches_init(&G);
+    Ordonnanceur_lance(I->O, &G, coupe, &droite);
+    coupe(&gauche);
+    Ordonnanceur_attend(I->O, &G);
+}
+
+void Ordonnanceur_parallele(Ordonnanceur *O, int n, int grain, FonctionBloc f, void *arg) {
+    Intervalle I = {O, f, arg, 0, n, grain > 0 ? grain : 1};
+    if (n > 0)
+        coupe(&I);
+}
+
+void Ordonnanceur_termine(Ordonnanceur *O) {
+    pthread_mutex_lock(&O->verrou);
+    O->fin = 1;
+    pthread_cond_broadcast(&O->reveil);
+    pthread_mutex_unlock(&O->verrou);
+    for (int k = 1; k < O->nb_fils; ++k)
+        pthread_join(O->fils[k], NULL);
+    for (int k = 0; k < O->nb_fils; ++k) {
+        Tableau_libere(O->files[k].taches, &O->files[k].taille, sizeof(Tache));
+        pthread_mutex_destroy(&O->files[k].verrou);
+    }
+    pthread_mutex_destroy(&O->verrou);
+    pthread_cond_destroy(&O->reveil);
+    free(O->files);
+    free(O->fils);
+    O->files = NULL;
+    O->fils = NULL;
+    O->nb_fils = 0;
+}
@@ -0,0 +1,117 @@
+#ifndef _ORDONNANCEUR_H_
+#define _ORDONNANCEUR_H_
+
+#include <pthread.h>
+
+/**
+   Un ordonnanceur de tâches par vol de travail (work stealing), pour
+   le parallélisme fork/join.
+
+   L'ordonnanceur possède nb_fils fils d'exécution: le fil qui l'a créé
+   (le numéro 0) et nb_fils-1 fils lancés par Ordonnanceur_init. Chaque
+   fil a sa file de tâches à deux bouts: il empile et dépile ses propres
+   tâches par le bas (la plus récente d'abord, ce qui garde les données
+   en cache), et un fil sans travail vole par le haut la tâche la plus
+   ancienne d'un autre (en général la plus grosse).
+
+   Une tâche est lancée dans un groupe (Ordonnanceur_lance), et
+   Ordonnanceur_attend attend la fin de toutes les tâches du groupe. En
+   attendant, le fil exécute lui-même des tâches au lieu de dormir: les
+   tâches peuvent donc en lancer d'autres et les attendre (parallélisme
+   imbriqué) sans jamais créer plus de fils que nb_fils.
+
+   Les files sont protégées chacune par un verrou: les tâches sont
+   grosses (un sous-arbre, un bloc de particules), si bien que ce verrou
+   n'est presque jamais disputé.
+*/
+
+/// Une fonction exécutée par une tâche.
+typedef void (*FonctionTache)(void *arg);
+
+/// Un ensemble de tâches que l'on attend ensemble.
+typedef struct SGroupeTaches {
+    int restantes; //< nombre de tâches lancées et pas encore terminées (accès atomiques)
+} GroupeTaches;
+
+typedef struct STache {
+    FonctionTache f;
+    void *arg;
+    GroupeTaches *groupe;
+} Tache;
+
+struct SOrdonnanceur;
+
+/// La file de tâches d'un fil.
+typedef struct SFileTaches {
+    pthread_mutex_t verrou;
+    int taille;                  //< capacité de l'anneau
+    int haut;                    //< position de la plus ancienne tâche (les voleurs prennent ici)
+    int bas;                     //< position après la plus récente (le propriétaire empile ici)
+    Tache *taches;               //< la tâche de position k est dans taches[k % taille]
+    struct SOrdonnanceur *O;     //< l'ordonnanceur, pour le fil qui possède cette file
+    int numero;                  //< le numéro de ce fil
+} FileTaches;
+
+typedef struct SOrdonnanceur {
+    int nb_fils;
+    FileTaches *files;           //< une file par fil
+    pthread_t *fils;             //< les fils 1..nb_fils-1 (le fil 0 est celui de l'appelant)
+    pthread_mutex_t verrou;      //< pour endormir les fils sans travail
+    pthread_cond_t reveil;
+    int en_attente;              //< nombre de tâches dans les files (accès atomiques)
+    int endormis;                //< nombre de fils endormis (accès atomiques)
+    int fin;                     //< vrai quand les fils doivent s'arrêter
+} Ordonnanceur;
+
+/**
+   Crée un ordonnanceur de \a nb_fils fils, celui de l'appelant compris
+   (\a nb_fils <= 0: un fil par processeur, moins -\a nb_fils, et au
+   moins un). Avec un seul fil, les tâches sont simplement exécutées à
+   leur lancement.
+
+   Le rôle du fil 0 peut être tenu par un autre fil que celui qui a
+   créé l'ordonnanceur, pourvu qu'un seul fil à la fois lance des
+   tâches depuis l'extérieur de l'ordonnanceur.
+*/
+void Ordonnanceur_init(Ordonnanceur *O, int nb_fils);
+
+/// @return le nombre de fils de l'ordonnanceur.
+int Ordonnanceur_nbFils(const Ordonnanceur *O);
+
+/**
+   @return le numéro (entre 0 et nb_fils-1) du fil qui appelle. Permet à
+   une tâche d'utiliser des tampons propres à son fil.
+*/
+int Ordonnanceur_numero(void);
+
+/// Initialise un groupe de tâches vide.
+void GroupeTaches_init(GroupeTaches *G);
+
+/**
+   Lance la tâche f(arg) dans le groupe \a G. Elle peut s'exécuter sur
+   n'importe quel fil, jusqu'à ce que Ordonnanceur_attend(O, G) retourne:
+   \a arg doit rester valide jusque-là.
+*/
+void Ordonnanceur_lance(Ordonnanceur *O, GroupeTaches *G, FonctionTache f, void *arg);
+
+/**
+   Attend que toutes les tâches du groupe \a G soient finies, en
+   exécutant des tâches en attendant.
+*/
+void Ordonnanceur_attend(Ordonnanceur *O, GroupeTaches *G);
+
+/// Une fonction qui traite les éléments [debut,fin[ d'un intervalle.
+typedef void (*FonctionBloc)(void *arg, int debut, int fin);
+
+/**
+   Appelle f(arg, debut, fin) sur des blocs disjoints qui recouvrent
+   [0,n[, en parallèle. L'intervalle est coupé en deux récursivement
+   jusqu'à des blocs d'au plus \a grain éléments: les voleurs prennent
+   ainsi d'abord les plus grosses moitiés.
+*/
+void Ordonnanceur_parallele(Ordonnanceur *O, int n, int grain, FonctionBloc f, void *arg);
+
+/// Arrête les fils et libère l'ordonnanceur. Aucune tâche ne doit être en cours.
+void Ordonnanceur_termine(Ordonnanceur *O);
+
+#endif
@@ -2,30 +2,51 @@
 #include <stdlib.h>
 #include <math.h>
 #include "particules.h"
+#include "tableau.h"
 
 void initParticule(Particule *p, double x, double y, double vx, double vy,
                    double m) {
+    for (int k = 0; k < DIM; ++k)
+        p->x[k] = p->v[k] = p->f[k] = 0.0;
     p->x[0] = x;
     p->x[1] = y;
     p->v[0] = vx;
     p->v[1] = vy;
-    p->f[0] = 0.0;
-    p->f[1] = 0.0;
     p->m = m;
+    p->id = -1;
+    p->calme = 0;
 }
 
 void TabParticules_init(TabParticules *tab) {
-    tab->taille = 10;
+    tab->taille = 0;
     tab->nb = 0;
-    tab->particules = (Particule *) malloc(tab->taille * sizeof(Particule));
+    tab->nb_dormantes = 0;
+    tab->prochain_id = 0;
+    tab->particules = NULL;
+    tab->tampon = NULL;
+    tab->taille_tampon = 0;
 }
 
 void TabParticules_ajoute(TabParticules *tab, Particule p) {
     if (tab->nb == tab->taille)
         TabParticules_agrandir(tab);
+    p.id = tab->prochain_id++;
     tab->particules[tab->nb++] = p;
 }
 
+Particule *TabParticules_ajouteN(TabParticules *tab, int n) {
+    assert (n >= 0);
+    if (tab->nb + n > tab->taille)
+        TabParticules_reserve(tab, tab->nb + n > 2 * tab->taille ? tab->nb + n : 2 * tab->taille);
+    Particule *debut = tab->particules + tab->nb;
+    for (int i = 0; i < n; ++i) {
+        debut[i].id = tab->prochain_id++;
+        debut[i].calme = 0;
+    }
+    tab->nb += n;
+    return debut;
+}
+
 void TabParticules_set(TabParticules *tab, int i, Particule p) {
     assert (i < tab->nb);
     tab->particules[i] = p;
@@ -45,31 +66,109 @@ int TabParticules_nb(TabParticules *tab) {
     return tab->nb;
 }
 
+int TabParticules_nbDormantes(TabParticules *tab) {
+    return tab->nb_dormantes;
+}
+
+static void echange(TabParticules *tab, int i, int j) {
+    Particule p = tab->particules[i];
+    tab->particules[i] = tab->particules[j];
+    tab->particules[j] = p;
+}
+
+void TabParticules_endort(TabParticules *tab, int i) {
+    assert (i >= tab->nb_dormantes && i < tab->nb);
+    Particule *p = tab->particules + i;
+    for (int k = 0; k < DIM; ++k)
+        p->v[k] = 0.0;
+    echange(tab, i, tab->nb_dormantes++);
+}
+
+void TabParticules_reveille(TabParticules *tab, int i) {
+    assert (i >= 0 && i < tab->nb_dormantes);
+    tab->particules[i].calme = 0;
+    echange(tab, i, --tab->nb_dormantes);
+}
+
+void TabParticules_reveilleTout(TabParticules *tab) {
+    for (int i = 0; i < tab->nb_dormantes; ++i)
+        tab->particules[i].calme = 0;
+    tab->nb_dormantes = 0;
+}
+
 void TabParticules_termine(TabParticules *tab) {
-    if (tab->particules != NULL) free(tab->particules);
-    tab->taille = 0;
+    Tableau_libere(tab->particules, &tab->taille, sizeof(Particule));
+    Tableau_libere(tab->tampon, &tab->taille_tampon, sizeof(Particule));
     tab->nb = 0;
+    tab->nb_dormantes = 0;
     tab->particules = NULL;
+    tab->tampon = NULL;
+}
+
+void TabParticules_reserve(TabParticules *tab, int n) {
+    tab->particules = Tableau_reserve(tab->particules, &tab->taille, tab->nb, n, sizeof(Particule));
+}
+
+void TabParticules_ajuste(TabParticules *tab) {
+    tab->particules = Tableau_ajuste(tab->particules, &tab->taille, tab->nb, sizeof(Particule));
+    Tableau_libere(tab->tampon, &tab->taille_tampon, sizeof(Particule));
+    tab->tampon = NULL;
 }
 
 void TabParticules_agrandir(TabParticules *tab) {
-    int new_taille = 2 * tab->taille;
-    Particule *new_pts = (Particule *) malloc(new_taille * sizeof(Particule));
-    for (int i = 0; i < tab->nb; ++i)
-        new_pts[i] = tab->particules[i];
-    free(tab->particules);
-    tab->particules = new_pts;
-    tab->taille = new_taille;
+    tab->particules = Tableau_agrandir(tab->particules, &tab->taille, tab->nb, sizeof(Particule));
+}
+
+void TabParticules_reordonne(TabParticules *tab, const int *ordre, int *ancien_vers_nouveau) {
+    // On recopie dans le tampon (agrandi au besoin à la capacité du tableau), puis on échange.
+    tab->tampon = Tableau_reserve(tab->tampon, &tab->taille_tampon, 0, tab->taille, sizeof(Particule));
+    Particule *nouv = tab->tampon;
+    int d = tab->nb_dormantes;
+    for (int i = 0; i < d; ++i)
+        nouv[i] = tab->particules[i];
+    for (int i = d; i < tab->nb; ++i)
+        nouv[i] = tab->particules[d + ordre[i - d]];
+    if (ancien_vers_nouveau != NULL) {
+        for (int i = 0; i < d; ++i)
+            ancien_vers_nouveau[i] = i;
+        for (int i = d; i < tab->nb; ++i)
+            ancien_vers_nouveau[d + ordre[i - d]] = i;
+    }
+    int taille = tab->taille_tampon;
+    tab->tampon = tab->particules;
+    tab->taille_tampon = tab->taille;
+    tab->particules = nouv;
+    tab->taille = taille;
+}
+
+void TabParticules_compacte(TabParticules *tab, int pas_sommeil) {
+    int e = tab->nb_dormantes; // case où écrire la prochaine particule gardée
+    for (int l = tab->nb_dormantes; l < tab->nb; ++l) {
+        Particule *p = tab->particules + l;
+        if (p->calme < 0)
+            continue;
+        tab->particules[e] = *p;
+        if (p->calme >= pas_sommeil)
+            TabParticules_endort(tab, e); // échange avec la première active, déjà tassée
+        ++e;
+    }
+    tab->nb = e;
 }
 
 void TabParticules_supprime_dernier(TabParticules *tab) {
     assert(tab->nb > 0);
-    --tab->nb;
+    if (--tab->nb < tab->nb_dormantes)
+        tab->nb_dormantes = tab->nb;
 }
 
 void TabParticules_supprime(TabParticules *tab, int i) {
     assert (i >= 0);
     assert (i < tab->nb);
+    if (i < tab->nb_dormantes) {
+        // La dernière dormante bouche le trou; sa case, devenue la première active, est à supprimer.
+        tab->particules[i] = tab->particules[--tab->nb_dormantes];
+        i = tab->nb_dormantes;
+    }
     tab->particules[i] = tab->particules[--tab->nb];
 }
 
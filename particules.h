@@ -6,29 +6,46 @@
 /// Représente un point / une particule en mouvement, avec position,
 /// mais aussi vitesse, force, et masse.
 typedef struct SParticule {
-    double x[DIM];  //< position x et y
-    double v[DIM];  //< vitesse x et y
-    double f[DIM];  //< somme des forces x et y
-    double m;       //< masse
+    Reel x[DIM];    //< position x et y
+    Reel v[DIM];    //< vitesse x et y
+    Reel f[DIM];    //< somme des forces x et y
+    Reel m;         //< masse
+    int id;         //< identifiant stable, donné par le tableau à l'ajout
+    int calme;      //< nombre de pas de temps consécutifs passés presque immobile (-1: à détruire)
 } Particule;
 
 /**
    Initialise le point \a p avec la position (x,y), la vitesse
-   (vx,vy), une masse \a m et des forces nulles.x  
+   (vx,vy), une masse \a m et des forces nulles. En 3D, les autres
+   coordonnées sont nulles.
 */
 void initParticule(Particule *p, double x, double y, double vx, double vy, double m);
 
 
-/// Représente un tableau dynamique de particules.
+/**
+   Représente un tableau dynamique de particules. L'indice d'une
+   particule change quand le tableau est réordonné ou quand une autre
+   particule est supprimée: pour suivre une particule dans le temps, il
+   faut retenir son \a id.
+
+   Les particules au repos (dormantes) sont rangées au début du tableau,
+   dans [0,nb_dormantes[, et les particules actives après elles. Seules
+   les actives sont à simuler: voir TabParticules_endort et
+   TabParticules_reveille.
+*/
 typedef struct STabParticule {
     int taille;
     int nb;
+    int nb_dormantes; //< nombre de particules dormantes, au début du tableau
+    int prochain_id; //< id donné à la prochaine particule ajoutée
     Particule *particules;
+    Particule *tampon; //< second tableau, échangé avec particules par TabParticules_reordonne
+    int taille_tampon;
 } TabParticules;
 
 /**
-   Initialise le tableau de particules \a tab. Il contient 0 particules initialement, mais
-   peut accueillir jusqu'à 10 particules sans être agrandi.
+   Initialise le tableau de particules \a tab. Il contient 0 particules
+   initialement, et n'alloue rien tant qu'on n'y ajoute rien.
 
    @param tab un pointeur vers une structure TabParticule.
 */
@@ -36,12 +53,24 @@ void TabParticules_init(TabParticules *tab);
 
 /**
    Ajoute si possible le particule \a p à la fin du tableau de particules \a tab.
+   Elle reçoit un nouvel id, et elle est active.
    
    @param tab  un pointeur vers une structure TabParticule valide.
    @param p une particule.
 */
 void TabParticules_ajoute(TabParticules *tab, Particule p);
 
+/**
+   Ajoute \a n particules non initialisées à la fin du tableau \a tab,
+   en l'agrandissant une seule fois si nécessaire. C'est l'appelant qui
+   remplit ensuite les cases retournées, sauf leur id qui est déjà donné.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param n le nombre de particules à ajouter.
+   @return un pointeur vers la première des \a n nouvelles particules.
+*/
+Particule *TabParticules_ajouteN(TabParticules *tab, int n);
+
 /**
    Modifie le \a i-ème point du tableau de points \a tab. Il devient
    le point \a p.
@@ -72,6 +101,34 @@ Particule *TabParticules_ref(TabParticules *tab, int i);
 */
 int TabParticules_nb(TabParticules *tab);
 
+/**
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @return le nombre de particules dormantes, qui est aussi l'indice de la première particule active.
+*/
+int TabParticules_nbDormantes(TabParticules *tab);
+
+/**
+   Endort la particule active \a i: elle est échangée avec la première
+   particule active, et passe ainsi dans la zone des dormantes. Sa
+   vitesse est remise à zéro.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param i l'indice d'une particule active.
+*/
+void TabParticules_endort(TabParticules *tab, int i);
+
+/**
+   Réveille la particule dormante \a i: elle est échangée avec la
+   dernière particule dormante, et passe ainsi dans la zone des actives.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param i l'indice d'une particule dormante.
+*/
+void TabParticules_reveille(TabParticules *tab, int i);
+
+/// Réveille toutes les particules dormantes.
+void TabParticules_reveilleTout(TabParticules *tab);
+
 /**
    Indique que le tableau de points \a tab n'est plus utilisé et
    libère la mémoire associée. Il passe à une taille 0.
@@ -80,11 +137,57 @@ int TabParticules_nb(TabParticules *tab);
  */
 void TabParticules_termine(TabParticules *tab);
 
+/**
+   Garantit que le tableau \a tab peut contenir \a n particules sans être
+   agrandi. À appeler avant d'ajouter beaucoup de particules d'un coup.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param n la capacité voulue.
+*/
+void TabParticules_reserve(TabParticules *tab, int n);
+
+/**
+   Réduit la mémoire occupée par le tableau \a tab au strict nécessaire
+   pour ses particules actuelles (équivalent de shrink_to_fit). Le
+   tampon de TabParticules_reordonne est libéré.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+*/
+void TabParticules_ajuste(TabParticules *tab);
+
 /**
    Utilisé en interne. Agrandit automatiquement le tableau si nécessaire.
 */
 void TabParticules_agrandir(TabParticules *tab);
 
+/**
+   Réordonne les particules actives du tableau \a tab: la i-ème particule
+   active devient celle qui était la ordre[i]-ème particule active. Les
+   particules dormantes ne bougent pas, et les id ne changent pas.
+   Les particules sont recopiées dans un second tableau, gardé d'un
+   appel à l'autre, qui est ensuite échangé avec le premier.
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param ordre une permutation de 0..(nombre de particules actives)-1.
+   @param ancien_vers_nouveau si non NULL, reçoit pour chaque ancien
+   indice le nouvel indice de la particule, pour les utilisateurs qui
+   ont retenu des indices.
+*/
+void TabParticules_reordonne(TabParticules *tab, const int *ordre, int *ancien_vers_nouveau);
+
+/**
+   Fait le tri des particules actives après un pas de temps, en un seul
+   parcours: celles dont le champ \a calme est négatif sont supprimées,
+   celles dont il atteint \a pas_sommeil sont endormies, et les autres
+   sont tassées en gardant leur ordre (partition stable). L'ordre des
+   particules restantes ne dépend donc pas de celles qui sont détruites
+   (seule la première active change de place quand une autre s'endort).
+
+   @param tab  un pointeur vers une structure TabParticule valide.
+   @param pas_sommeil le nombre de pas lents au bout duquel une particule s'endort.
+*/
+void TabParticules_compacte(TabParticules *tab, int pas_sommeil);
+
 /**
    Supprime le dernier élément du tableau.
 */
@@ -92,7 +195,9 @@ void TabParticules_supprime_dernier(TabParticules *tab);
 
 /**
    Supprime un élément en position \a i du tableau. Met le dernier
-   élément du tableau à la place.
+   élément du tableau à la place (si c'est une dormante, c'est la
+   dernière dormante qui prend sa place, et la dernière particule du
+   tableau qui prend celle de la dernière dormante).
   */
 void TabParticules_supprime(TabParticules *tab, int i);
 
@@ -3,54 +3,75 @@
 
 
 Point Point_sub(Point p, Point q) {
-    p.x[0] -= q.x[0];
-    p.x[1] -= q.x[1];
+    for (int k = 0; k < DIM; ++k)
+        p.x[k] -= q.x[k];
     return p;
 }
 
 Point Point_add(Point p, Point q) {
-    p.x[0] += q.x[0];
-    p.x[1] += q.x[1];
+    for (int k = 0; k < DIM; ++k)
+        p.x[k] += q.x[k];
     return p;
 }
 
-Point Point_mul(double c, Point p) {
-    p.x[0] *= c;
-    p.x[1] *= c;
+Point Point_mul(Reel c, Point p) {
+    for (int k = 0; k < DIM; ++k)
+        p.x[k] *= c;
     return p;
 }
 
-double Point_dot(Point p, Point q) {
-    return p.x[0] * q.x[0] + p.x[1] * q.x[1];
+Reel Point_dot(Point p, Point q) {
+    Reel s = 0.0;
+    for (int k = 0; k < DIM; ++k)
+        s += p.x[k] * q.x[k];
+    return s;
 }
 
-double Point_norm2(Point p) {
+Reel Point_norm2(Point p) {
     return Point_dot(p, p);
 }
 
-double Point_norm(Point p) {
+Reel Point_norm(Point p) {
     return sqrt(Point_norm2(p));
 }
 
-double Point_distance(Point p, Point q) {
-    return distance(p.x[0], p.x[1], q.x[0], q.x[1]);
+Reel Point_distance(Point p, Point q) {
+    return distanceCoord(p.x, q.x);
 }
 
 Point Point_normalize(Point p) {
     return Point_mul(1.0 / Point_norm(p), p);
 }
 
-static int compteur_distance = 0;
+// Chaque fil compte ses appels dans son propre compteur, et les reporte
+// de temps en temps dans le compteur global (reporteCompteurDistance):
+// les fils ne se disputent pas une même variable à chaque appel.
+static __thread int compteur_distance = 0;
+static int compteur_global = 0;
 
 double distance(double x1, double y1, double x2, double y2) {
     ++compteur_distance;
     return sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2));
 }
 
+double distanceCoord(const Reel p[DIM], const Reel q[DIM]) {
+    ++compteur_distance;
+    double s = 0.0;
+    for (int k = 0; k < DIM; ++k)
+        s += (p[k] - q[k]) * (p[k] - q[k]);
+    return sqrt(s);
+}
+
+void reporteCompteurDistance() {
+    __atomic_fetch_add(&compteur_global, compteur_distance, __ATOMIC_RELAXED);
+    compteur_distance = 0;
+}
+
 void resetCompteurDistance() {
+    __atomic_store_n(&compteur_global, 0, __ATOMIC_RELAXED);
     compteur_distance = 0;
 }
 
 int getCompteurDistance() {
-    return compteur_distance;
+    return __atomic_load_n(&compteur_global, __ATOMIC_RELAXED) + compteur_distance;
 }
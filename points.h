@@ -1,13 +1,33 @@
 #ifndef _POINTS_H_
 #define _POINTS_H_
 
-// On est dans le plan, il faut deux coordonnées. La dimension est donc 2.
+// On est dans le plan, il faut deux coordonnées. La dimension est donc 2
+// par défaut; make DIM=3 compile une simulation dans l'espace. Toutes les
+// boucles sur les coordonnées ont DIM comme borne constante: le
+// compilateur les déroule, et le code 2D ne paie rien pour la 3D.
+#ifndef DIM
 #define DIM 2
+#endif
+#if DIM != 2 && DIM != 3
+#error "DIM doit valoir 2 ou 3"
+#endif
+
+/// Le type des coordonnées, vitesses, forces et rayons de la simulation:
+/// double par défaut, float si PRECISION_SIMPLE est défini (make
+/// PRECISION=simple). En float, une particule prend deux fois moins de
+/// mémoire et les vecteurs SIMD traitent deux fois plus de composantes,
+/// ce qui suffit largement pour le domaine [-1.5,1.5]² affiché sur 500
+/// pixels; le double reste le mode de référence pour valider.
+#ifdef PRECISION_SIMPLE
+typedef float Reel;
+#else
+typedef double Reel;
+#endif
 
 /// Un point est une structure contenant un tableau de DIM double, ses
 /// coordonnées.
 typedef struct SPoint {
-    double x[DIM];
+    Reel x[DIM];
 } Point;
 
 /// @return le vecteur p-q
@@ -17,26 +37,33 @@ Point Point_sub(Point p, Point q);
 Point Point_add(Point p, Point q);
 
 /// @return le vecteur c.p (multiplication scalaire d'un vecteur)
-Point Point_mul(double c, Point p);
+Point Point_mul(Reel c, Point p);
 
 /// @return le produit scalaire p * q
-double Point_dot(Point p, Point q);
+Reel Point_dot(Point p, Point q);
 
 /// @return la norme au carré du vecteur p.
-double Point_norm2(Point p);
+Reel Point_norm2(Point p);
 
 /// @return la norme du vecteur p.
-double Point_norm(Point p);
+Reel Point_norm(Point p);
 
 /// @return la distance entre les deux points p et q, qui est aussi la norme de p-q.
-double Point_distance(Point p, Point q);
+Reel Point_distance(Point p, Point q);
 
 /// @return le vecteur de norme 1 aligné avec le vecteur p.
 Point Point_normalize(Point p);
 
-/// @return la distance entre (x1,y1) et (x2,y2).
+/// @return la distance entre (x1,y1) et (x2,y2), dans le plan.
 double distance(double x1, double y1, double x2, double y2);
 
+/// @return la distance entre les points de coordonnées \a p et \a q, en dimension DIM.
+double distanceCoord(const Reel p[DIM], const Reel q[DIM]);
+
+/// Ajoute au compteur global les appels à distance faits par le fil
+/// courant. À appeler par les fils de calcul à la fin de leur travail.
+void reporteCompteurDistance();
+
 /// Remet à zéro le compteur du nombre d'appel à distance.
 void resetCompteurDistance();
 
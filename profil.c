@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 199309L // pour clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include "profil.h"
+#include "tableau.h"
+
+static const char *noms[NB_PHASES] = {
+    "pas", "emission", "dynamique", "recherche", "collisions", "bords", "histo", "affichage"
+};
+
+static int64_t maintenant(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t) t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+void Profil_init(Profil *P, int trace) {
+    P->origine = maintenant();
+    for (int ph = 0; ph < NB_PHASES; ++ph) {
+        P->cumul[ph] = 0;
+        P->mesuree[ph] = 0;
+        P->nb_mesures[ph] = 0;
+    }
+    P->trace = trace;
+    P->taille_pas = 0;
+    P->nb_pas = 0;
+    P->pas = NULL;
+}
+
+int64_t Profil_debut(void) {
+    return maintenant();
+}
+
+void Profil_fin(Profil *P, PhaseProfil ph, int64_t debut) {
+    P->cumul[ph] += maintenant() - debut;
+    P->mesuree[ph] = 1;
+}
+
+void Profil_repartit(Profil *P, int64_t debut, const int64_t temps[NB_PHASES]) {
+    int64_t ecoule = maintenant() - debut;
+    int64_t total = 0;
+    for (int ph = 0; ph < NB_PHASES; ++ph)
+        total += temps[ph];
+    for (int ph = 0; ph < NB_PHASES; ++ph)
+        if (temps[ph] > 0) {
+            P->cumul[ph] += (int64_t) ((double) ecoule * temps[ph] / total);
+            P->mesuree[ph] = 1;
+        }
+}
+
+void Profil_finPas(Profil *P, int64_t debut) {
+    Profil_fin(P, PHASE_PAS, debut);
+    if (P->trace) {
+        if (P->nb_pas == P->taille_pas)
+            P->pas = Tableau_agrandir(P->pas, &P->taille_pas, P->nb_pas, sizeof(PasProfil));
+        PasProfil *pas = P->pas + P->nb_pas++;
+        pas->debut = debut - P->origine;
+        for (int ph = 0; ph < NB_PHASES; ++ph)
+            pas->duree[ph] = P->cumul[ph];
+    }
+    for (int ph = 0; ph < NB_PHASES; ++ph)
+        if (P->mesuree[ph]) {
+            P->fenetre[ph][P->nb_mesures[ph]++ % PROFIL_FENETRE] = P->cumul[ph];
+            P->cumul[ph] = 0;
+            P->mesuree[ph] = 0;
+        }
+}
+
+static int compDurees(const void *a, const void *b) {
+    int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+void Profil_stats(const Profil *P, PhaseProfil ph, double *min, double *moy, double *p99) {
+    int n = P->nb_mesures[ph] < PROFIL_FENETRE ? P->nb_mesures[ph] : PROFIL_FENETRE;
+    *min = *moy = *p99 = 0.0;
+    if (n == 0)
+        return;
+    int64_t d[PROFIL_FENETRE];
+    int64_t somme = 0;
+    for (int k = 0; k < n; ++k) {
+        d[k] = P->fenetre[ph][k];
+        somme += d[k];
+    }
+    qsort(d, n, sizeof(int64_t), compDurees);
+    // Le 99e centile est la plus petite durée qui dépasse 99% des mesures.
+    int c = (99 * n + 99) / 100 - 1;
+    *min = d[0] * 1e-3;
+    *moy = (double) somme / n * 1e-3;
+    *p99 = d[c] * 1e-3;
+}
+
+void Profil_resume(const Profil *P, char *texte, int taille) {
+    int n = snprintf(texte, taille, "%-10s %8s %8s %8s (µs)", "", "min", "moy", "p99");
+    for (int ph = 0; ph < NB_PHASES && n < taille; ++ph) {
+        if (P->nb_mesures[ph] == 0)
+            continue;
+        double min, moy, p99;
+        Profil_stats(P, ph, &min, &moy, &p99);
+        n += snprintf(texte + n, taille - n, "\n%-10s %8.1f %8.1f %8.1f", noms[ph], min, moy, p99);
+    }
+}
+
+const char *Profil_nom(PhaseProfil ph) {
+    assert(ph >= 0 && ph < NB_PHASES);
+    return noms[ph];
+}
+
+// Écrit un événement "complet" (ph X) de Chrome; les temps sont en µs.
+static void ecritEvenement(FILE *f, const char *nom, int64_t debut, int64_t duree, int premier) {
+    fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+            premier ? "" : ",", nom, debut * 1e-3, duree * 1e-3);
+}
+
+int Profil_ecritTrace(const Profil *P, const char *nom) {
+    FILE *f = fopen(nom, "w");
+    if (f == NULL) {
+        perror(nom);
+        return -1;
+    }
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (int k = 0; k < P->nb_pas; ++k) {
+        const PasProfil *pas = P->pas + k;
+        ecritEvenement(f, noms[PHASE_PAS], pas->debut, pas->duree[PHASE_PAS], k == 0);
+        int64_t t = pas->debut;
+        for (int ph = PHASE_PAS + 1; ph < NB_PHASES; ++ph)
+            if (pas->duree[ph] > 0) {
+                ecritEvenement(f, noms[ph], t, pas->duree[ph], 0);
+                t += pas->duree[ph];
+            }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+void Profil_termine(Profil *P) {
+    Tableau_libere(P->pas, &P->taille_pas, sizeof(PasProfil));
+    P->pas = NULL;
+    P->nb_pas = 0;
+}
@@ -0,0 +1,121 @@
+#ifndef _PROFIL_H_
+#define _PROFIL_H_
+
+#include <stdint.h>
+
+/**
+   Les phases d'un pas de temps mesurées par le profileur. PHASE_PAS
+   englobe tout le pas; les autres sont mesurées à l'intérieur, et ce
+   qui reste (tri de Morton, mobiles, champ de distance) est la
+   différence entre le pas et leur somme.
+*/
+typedef enum {
+    PHASE_PAS,        //< le pas de temps complet
+    PHASE_EMISSION,   //< création des particules par les émetteurs
+    PHASE_DYNAMIQUE,  //< forces et vitesses (calculDynamique)
+    PHASE_RECHERCHE,  //< recherche des obstacles candidats (arbre k-D, BVH)
+    PHASE_COLLISIONS, //< déplacement des particules et rebonds
+    PHASE_BORDS,      //< bords du domaine, sommeil et compactage du tableau
+    PHASE_HISTO,      //< accumulation et écriture de l'histogramme des particules
+    PHASE_AFFICHAGE,  //< dessin de la zone (mesuré à chaque image, pas à chaque pas)
+    NB_PHASES
+} PhaseProfil;
+
+/// Nombre de pas gardés pour les statistiques glissantes.
+#define PROFIL_FENETRE 256
+
+/// Le temps passé dans chaque phase pendant un pas (pour la trace).
+typedef struct SPasProfil {
+    int64_t debut;              //< début du pas, en ns depuis Profil_init
+    int64_t duree[NB_PHASES];   //< durée de chaque phase pendant ce pas, en ns
+} PasProfil;
+
+/**
+   Un profileur par phases. On encadre une portion de code par
+
+       int64_t t = Profil_debut();
+       ...
+       Profil_fin(P, PHASE_..., t);
+
+   Une phase peut être mesurée plusieurs fois par pas (par exemple une
+   fois par paquet de particules): ses durées s'additionnent. À la fin
+   du pas, Profil_finPas range le total de chaque phase dans une fenêtre
+   des PROFIL_FENETRE derniers pas, d'où l'on tire min, moyenne et 99e
+   centile. Une mesure coûte deux lectures de l'horloge monotone.
+
+   Si la trace est demandée, chaque pas est aussi gardé en entier, pour
+   être écrit à la fin au format "trace event" de Chrome
+   (chrome://tracing ou ui.perfetto.dev).
+*/
+typedef struct SProfil {
+    int64_t origine;                              //< instant de Profil_init
+    int64_t cumul[NB_PHASES];                     //< durée de chaque phase depuis la fin du dernier pas
+    int mesuree[NB_PHASES];                       //< vrai si la phase a été mesurée depuis la fin du dernier pas
+    int64_t fenetre[NB_PHASES][PROFIL_FENETRE];   //< les dernières durées de chaque phase, en anneau
+    int nb_mesures[NB_PHASES];                    //< nombre de durées rangées dans la fenêtre depuis le début
+    int trace;                                    //< vrai si on garde tous les pas
+    int taille_pas;
+    int nb_pas;
+    PasProfil *pas;                               //< tous les pas, si trace
+} Profil;
+
+/**
+   Initialise le profileur \a P. Si \a trace est vrai, tous les pas sont
+   gardés pour Profil_ecritTrace.
+*/
+void Profil_init(Profil *P, int trace);
+
+/// @return l'instant présent, en ns, pour le passer ensuite à Profil_fin.
+int64_t Profil_debut(void);
+
+/**
+   Ajoute à la phase \a ph le temps écoulé depuis \a debut (donné par
+   Profil_debut).
+*/
+void Profil_fin(Profil *P, PhaseProfil ph, int64_t debut);
+
+/**
+   Répartit le temps écoulé depuis \a debut entre les phases, au prorata
+   des durées \a temps. Sert pour une portion de code exécutée par
+   plusieurs fils: chaque fil mesure ses phases, et la somme de leurs
+   temps dépasse le temps réellement écoulé.
+*/
+void Profil_repartit(Profil *P, int64_t debut, const int64_t temps[NB_PHASES]);
+
+/**
+   Termine le pas commencé à l'instant \a debut: la durée du pas est
+   rangée dans PHASE_PAS, et celle de chaque phase mesurée depuis le pas
+   précédent dans sa fenêtre.
+*/
+void Profil_finPas(Profil *P, int64_t debut);
+
+/**
+   Calcule les statistiques de la phase \a ph sur la fenêtre glissante,
+   en microsecondes. Tout est nul si la phase n'a jamais été mesurée.
+*/
+void Profil_stats(const Profil *P, PhaseProfil ph, double *min, double *moy, double *p99);
+
+/**
+   Écrit dans \a texte (de \a taille caractères) un tableau des
+   statistiques des phases déjà mesurées, une ligne par phase.
+*/
+void Profil_resume(const Profil *P, char *texte, int taille);
+
+/// @return le nom de la phase \a ph.
+const char *Profil_nom(PhaseProfil ph);
+
+/**
+   Écrit les pas gardés dans le fichier \a nom, au format JSON "trace
+   event" de Chrome. Chaque pas est un événement qui contient ses
+   phases. Les phases mesurées par morceaux (recherche, collisions,
+   bords, mesurées paquet par paquet) y sont mises bout à bout avec leur
+   durée totale.
+
+   @return 0 si tout va bien, -1 si le fichier n'a pas pu être écrit.
+*/
+int Profil_ecritTrace(const Profil *P, const char *nom);
+
+/// Libère la mémoire du profileur.
+void Profil_termine(Profil *P);
+
+#endif
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "scene.h"
+
+// Taille du tampon de lecture: le fichier est lu par blocs de cette
+// taille, quelle que soit sa longueur totale.
+#define TAILLE_TAMPON (1 << 20)
+
+/// Lit un fichier ligne par ligne, par gros blocs, sans limite de taille de fichier.
+typedef struct SLecteur {
+    FILE *f;
+    char *tampon;
+    size_t debut; //< début de la partie non encore lue du tampon
+    size_t fin;   //< fin des données valides du tampon
+    int eof;
+} Lecteur;
+
+// Retourne la ligne suivante (terminée par '\0', sans le '\n'), ou NULL à la fin du fichier.
+// Une ligne plus longue que le tampon est coupée.
+static char *ligneSuivante(Lecteur *l) {
+    for (;;) {
+        char *debut = l->tampon + l->debut;
+        char *nl = memchr(debut, '\n', l->fin - l->debut);
+        if (nl != NULL) {
+            *nl = '\0';
+            l->debut = nl - l->tampon + 1;
+            return debut;
+        }
+        if (l->eof || (l->debut == 0 && l->fin == TAILLE_TAMPON - 1)) {
+            if (l->debut == l->fin) return NULL;
+            l->tampon[l->fin] = '\0';
+            l->debut = l->fin;
+            return debut;
+        }
+        // Ramène le morceau de ligne en début de tampon et complète le bloc.
+        memmove(l->tampon, debut, l->fin - l->debut);
+        l->fin -= l->debut;
+        l->debut = 0;
+        size_t lu = fread(l->tampon + l->fin, 1, TAILLE_TAMPON - 1 - l->fin, l->f);
+        l->fin += lu;
+        if (lu == 0) l->eof = 1;
+    }
+}
+
+// Lit n réels consécutifs dans s. Retourne 1 si on a bien trouvé les n
+// réels et rien d'autre derrière.
+static int lisReels(const char *s, double *T, int n) {
+    char *fin;
+    for (int i = 0; i < n; ++i) {
+        T[i] = strtod(s, &fin);
+        if (fin == s) return 0;
+        s = fin;
+    }
+    while (*s == ' ' || *s == '\t' || *s == '\r') ++s;
+    return *s == '\0';
+}
+
+// Lit la fin d'une ligne "emetteur": le débit, la vitesse, sa loi et la masse.
+static int lisDynamique(const char *s, Emetteur *e) {
+    char loi[16];
+    if (sscanf(s, "%lf %lf %lf %15s %lf %lf %lf", &e->debit, &e->v[0], &e->v[1],
+               loi, &e->dv, &e->m, &e->dm) != 7)
+        return 0;
+    if (strcmp(loi, "uniforme") == 0)
+        e->loi_v = LOI_UNIFORME;
+    else if (strcmp(loi, "normale") == 0)
+        e->loi_v = LOI_NORMALE;
+    else
+        return 0;
+    return e->debit >= 0.0 && e->m > 0.0;
+}
+
+// Analyse une ligne "emetteur ..." (sans le mot-clé). Retourne 0 si elle est mal formée.
+static int lisEmetteur(const char *s, Emetteur *e, uint64_t graine, int flux) {
+    char forme[16];
+    int n;
+    if (sscanf(s, "%15s%n", forme, &n) != 1)
+        return 0;
+    s += n;
+    initEmetteur(e, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, graine, flux);
+    if (strcmp(forme, "point") == 0) {
+        e->forme = EMET_POINT;
+        if (sscanf(s, "%lf %lf%n", &e->x[0], &e->x[1], &n) != 2) return 0;
+    } else if (strcmp(forme, "ligne") == 0) {
+        e->forme = EMET_LIGNE;
+        if (sscanf(s, "%lf %lf %lf %lf%n", &e->x[0], &e->x[1], &e->x2[0], &e->x2[1], &n) != 4) return 0;
+    } else if (strcmp(forme, "disque") == 0) {
+        e->forme = EMET_DISQUE;
+        if (sscanf(s, "%lf %lf %lf%n", &e->x[0], &e->x[1], &e->r, &n) != 3) return 0;
+    } else
+        return 0;
+    return lisDynamique(s + n, e);
+}
+
+// Analyse une ligne "obstacle x y r att cr cg cb". C'est la directive
+// la plus fréquente dans les grosses scènes, d'où strtod plutôt que sscanf.
+static int lisObstacle(const char *s, TabObstacles *O) {
+    double v[7];
+    if (!lisReels(s, v, 7) || v[2] <= 0.0)
+        return 0;
+    Obstacle o;
+    initObstacle(&o, DISQUE, v[0], v[1], v[2], v[3], v[4], v[5], v[6]);
+    TabObstacles_ajoute(O, o);
+    return 1;
+}
+
+// Analyse une ligne "segment x1 y1 x2 y2 att cr cg cb" (r = 0),
+// "capsule x1 y1 x2 y2 r att cr cg cb" ou "boite xmin ymin xmax ymax att cr cg cb".
+static int lisMur(const char *s, ObstacleType type, TabObstacles *murs) {
+    double v[9];
+    int r = type == CAPSULE; // seule la capsule a un rayon
+    if (!lisReels(s, v, 8 + r) || (r && v[4] <= 0.0))
+        return 0;
+    Obstacle o;
+    initObstacleEtendu(&o, type, v[0], v[1], v[2], v[3], r ? v[4] : 0.0,
+                       v[4 + r], v[5 + r], v[6 + r], v[7 + r]);
+    TabObstacles_ajoute(murs, o);
+    return 1;
+}
+
+// Analyse une ligne "domaine xmin ymin xmax ymax bordx bordy".
+static int lisDomaine(const char *s, Domaine *D) {
+    double v[4];
+    char bx[16], by[16];
+    TypeBord tx, ty;
+    if (sscanf(s, "%lf %lf %lf %lf %15s %15s", &v[0], &v[1], &v[2], &v[3], bx, by) != 6
+        || !Domaine_lisBord(bx, &tx) || !Domaine_lisBord(by, &ty)
+        || v[0] == v[2] || v[1] == v[3])
+        return 0;
+    Domaine_init(D, v[0], v[1], v[2], v[3], tx, ty);
+    return 1;
+}
+
+// Analyse une ligne "galton x y rangees espacement r att cr cg cb": une
+// planche de Galton triangulaire dont le sommet est en (x,y). La rangée
+// k contient k+1 plots, espacés de \a espacement.
+static int lisGalton(const char *s, TabObstacles *O) {
+    double v[9];
+    if (!lisReels(s, v, 9) || v[2] < 1.0 || v[4] <= 0.0)
+        return 0;
+    int rangees = (int) v[2];
+    double e = v[3];
+    double h = e * sqrt(3.0) / 2.0;
+    for (int k = 0; k < rangees; ++k)
+        for (int j = 0; j <= k; ++j) {
+            Obstacle o;
+            initObstacle(&o, DISQUE, v[0] + (j - k / 2.0) * e, v[1] - k * h,
+                         v[4], v[5], v[6], v[7], v[8]);
+            TabObstacles_ajoute(O, o);
+        }
+    return 1;
+}
+
+// Analyse une ligne "piston x y ax ay omega r att cr cg cb": un disque
+// qui oscille autour de (x,y) avec l'amplitude (ax,ay).
+static int lisPiston(const char *s, Mobiles *M) {
+    double v[11];
+    if (!lisReels(s, v, 11) || v[5] <= 0.0)
+        return 0;
+    Obstacle o;
+    Mouvement m = {0};
+    initObstacle(&o, DISQUE, v[0], v[1], v[5], v[6], v[7], v[8], v[9]);
+    m.type = OSCILLE;
+    m.c[0] = v[0];
+    m.c[1] = v[1];
+    m.a[0] = v[2];
+    m.a[1] = v[3];
+    m.omega = v[4];
+    Mobiles_ajoute(M, o, m);
+    return 1;
+}
+
+// Analyse une ligne "palette px py longueur n omega angle0 r att cr cg cb":
+// n disques alignés sur un bras qui tourne autour du pivot (px,py).
+static int lisPalette(const char *s, Mobiles *M) {
+    double v[11];
+    if (!lisReels(s, v, 11) || v[3] < 1.0 || v[6] <= 0.0)
+        return 0;
+    int n = (int) v[3];
+    for (int k = 0; k < n; ++k) {
+        double l = n == 1 ? 0.0 : v[2] * k / (n - 1);
+        Obstacle o;
+        Mouvement m = {0};
+        initObstacle(&o, DISQUE, v[0], v[1], v[6], v[7], v[8], v[9], v[10]);
+        m.type = TOURNE;
+        m.c[0] = v[0];
+        m.c[1] = v[1];
+        m.a[0] = l * cos(v[5]);
+        m.a[1] = l * sin(v[5]);
+        m.omega = v[4];
+        Mobiles_ajoute(M, o, m);
+    }
+    return 1;
+}
+
+int Scene_charge(const char *nom, TabEmetteurs *E, TabObstacles *O, TabObstacles *murs, Mobiles *M,
+                 Domaine *D, uint64_t graine) {
+    Lecteur l;
+    l.f = fopen(nom, "r");
+    if (l.f == NULL) {
+        perror(nom);
+        return -1;
+    }
+    l.tampon = (char *) malloc(TAILLE_TAMPON);
+    l.debut = l.fin = 0;
+    l.eof = 0;
+    char mot[32];
+    int num = 0;
+    int erreurs = 0;
+    char *ligne;
+    while ((ligne = ligneSuivante(&l)) != NULL) {
+        ++num;
+        char *diese = strchr(ligne, '#');
+        if (diese != NULL) *diese = '\0';
+        int n;
+        if (sscanf(ligne, "%31s%n", mot, &n) != 1)
+            continue; // ligne vide
+        int ok = 0;
+        if (strcmp(mot, "obstacle") == 0)
+            ok = lisObstacle(ligne + n, O);
+        else if (strcmp(mot, "segment") == 0)
+            ok = lisMur(ligne + n, SEGMENT, murs);
+        else if (strcmp(mot, "capsule") == 0)
+            ok = lisMur(ligne + n, CAPSULE, murs);
+        else if (strcmp(mot, "boite") == 0)
+            ok = lisMur(ligne + n, BOITE, murs);
+        else if (strcmp(mot, "galton") == 0)
+            ok = lisGalton(ligne + n, O);
+        else if (strcmp(mot, "piston") == 0)
+            ok = lisPiston(ligne + n, M);
+        else if (strcmp(mot, "palette") == 0)
+            ok = lisPalette(ligne + n, M);
+        else if (strcmp(mot, "domaine") == 0)
+            ok = lisDomaine(ligne + n, D);
+        else if (strcmp(mot, "emetteur") == 0) {
+            Emetteur e;
+            // Le flux 0 est réservé au générateur du programme principal.
+            ok = lisEmetteur(ligne + n, &e, graine, TabEmetteurs_nb(E) + 1);
+            if (ok) TabEmetteurs_ajoute(E, e);
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%d: ligne ignorée\n", nom, num);
+            ++erreurs;
+        }
+    }
+    free(l.tampon);
+    fclose(l.f);
+    return erreurs;
+}
@@ -0,0 +1,67 @@
+#ifndef _SCENE_H_
+#define _SCENE_H_
+
+#include <stdint.h>
+#include "emetteurs.h"
+#include "obstacles.h"
+#include "mobiles.h"
+#include "domaine.h"
+
+/**
+   Charge le fichier de scène \a nom et ajoute à \a E, \a O, \a murs et
+   \a M les émetteurs, les disques fixes, les obstacles étendus (murs) et
+   les obstacles mobiles qu'il décrit, et règle le domaine \a D s'il
+   en donne un. Le fichier est un fichier
+   texte, avec une directive par ligne. Les lignes vides et ce qui suit
+   un '#' sont ignorés. Il est lu par blocs, et peut donc contenir des
+   millions d'obstacles: c'est à l'appelant de construire l'arbre k-D
+   une seule fois après le chargement.
+
+   Directives reconnues:
+
+   - `obstacle x y r att cr cg cb` : un disque de centre (x,y), de rayon
+     \a r, d'atténuation \a att et de couleur (cr,cg,cb).
+   - `segment x1 y1 x2 y2 att cr cg cb` : un mur sans épaisseur de
+     (x1,y1) à (x2,y2).
+   - `capsule x1 y1 x2 y2 r att cr cg cb` : un mur épais, ensemble des
+     points à distance au plus \a r du segment de (x1,y1) à (x2,y2).
+   - `boite xmin ymin xmax ymax att cr cg cb` : un rectangle plein aux
+     côtés parallèles aux axes.
+   - `galton x y rangees espacement r att cr cg cb` : une planche de
+     Galton, triangle de disques de sommet (x,y) dont la rangée k
+     contient k+1 disques espacés de \a espacement.
+   - `piston x y ax ay omega r att cr cg cb` : un disque mobile qui
+     oscille autour de (x,y): sa position est (x,y) + sin(omega t) (ax,ay).
+   - `palette px py longueur n omega angle0 r att cr cg cb` : n disques
+     mobiles alignés sur un bras de longueur \a longueur, qui tourne
+     autour du pivot (px,py) à \a omega rad/s en partant de l'angle
+     \a angle0.
+
+   - `domaine xmin ymin xmax ymax bordx bordy` : le domaine de
+     simulation, avec le type de ses bords en x et en y (`ouvert`,
+     `periodique` ou `reflechissant`).
+
+   - `emetteur point  x y         debit vx vy loi dv m dm`
+   - `emetteur ligne  x1 y1 x2 y2 debit vx vy loi dv m dm`
+   - `emetteur disque x y r       debit vx vy loi dv m dm`
+
+   où \a debit est en particules par seconde, \a loi vaut `uniforme` ou
+   `normale` (dispersion \a dv de chaque composante de la vitesse), et
+   la masse varie uniformément dans [m-dm,m+dm].
+
+   Les lignes mal formées sont signalées sur la sortie d'erreur et
+   ignorées.
+
+   @param nom le nom du fichier de scène.
+   @param E un pointeur vers un tableau d'émetteurs valide.
+   @param O un pointeur vers un tableau d'obstacles valide.
+   @param murs un pointeur vers un tableau d'obstacles valide, pour les segments, capsules et boîtes.
+   @param M un pointeur vers des obstacles mobiles valides.
+   @param D un pointeur vers un domaine valide, inchangé si la scène n'en donne pas.
+   @param graine la graine donnée aux générateurs des émetteurs (chacun sur son flux).
+   @return le nombre de lignes mal formées, ou -1 si le fichier n'a pas pu être ouvert.
+*/
+int Scene_charge(const char *nom, TabEmetteurs *E, TabObstacles *O, TabObstacles *murs, Mobiles *M,
+                 Domaine *D, uint64_t graine);
+
+#endif
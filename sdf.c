@@ -0,0 +1,261 @@
+#include <math.h>
+#include <string.h>
+#include "sdf.h"
+#include "collisions.h"
+#include "tableau.h"
+
+void SDF_init(SDF *S, IndexObstacles *I, const double bmin[DIM], const double bmax[DIM],
+              double pas, double bande) {
+    S->index = I;
+    S->pas = pas;
+    S->bande = bande;
+    for (int a = 0; a < DIM; ++a) {
+        S->bmin[a] = bmin[a];
+        S->n[a] = (int) ceil((bmax[a] - bmin[a]) / pas) + 1;
+        S->nt[a] = (S->n[a] + SDF_TUILE - 1) / SDF_TUILE;
+        S->saut[a] = a == 0 ? 1 : S->saut[a - 1] * S->n[a - 1];
+    }
+    S->valeurs = NULL;
+    S->taille_valeurs = 0;
+    S->sales = NULL;
+    S->taille_sales = 0;
+    S->nb_sales = 0;
+    S->pret = 0;
+    TabObstacles_init(&S->candidats);
+}
+
+// Passe au multi-indice i suivant dans le pavé [lo,hi[ (ordre
+// lexicographique, premier axe le plus rapide). Retourne 0 à la fin.
+static int suivant(int i[DIM], const int lo[DIM], const int hi[DIM]) {
+    for (int a = 0; a < DIM; ++a) {
+        if (++i[a] < hi[a])
+            return 1;
+        i[a] = lo[a];
+    }
+    return 0;
+}
+
+static int nbNoeuds(const SDF *S) {
+    return S->saut[DIM - 1] * S->n[DIM - 1];
+}
+
+static int nbTuiles(const SDF *S) {
+    int nb = 1;
+    for (int a = 0; a < DIM; ++a)
+        nb *= S->nt[a];
+    return nb;
+}
+
+static ValeurSDF *noeud(SDF *S, const int i[DIM]) {
+    int k = 0;
+    for (int a = 0; a < DIM; ++a)
+        k += i[a] * S->saut[a];
+    return S->valeurs + k;
+}
+
+static unsigned char *tuile(SDF *S, const int t[DIM]) {
+    int k = 0;
+    for (int a = DIM - 1; a >= 0; --a)
+        k = k * S->nt[a] + t[a];
+    return S->sales + k;
+}
+
+// Plage [lo[a],hi[a][ des noeuds à moins de la bande de la boîte de l'obstacle o.
+static int plageNoeuds(const SDF *S, const Obstacle *o, int lo[DIM], int hi[DIM]) {
+    double omin[DIM], omax[DIM];
+    Obstacle_boite(o, omin, omax);
+    for (int a = 0; a < DIM; ++a) {
+        lo[a] = (int) ceil((omin[a] - S->bande - S->bmin[a]) / S->pas);
+        hi[a] = (int) floor((omax[a] + S->bande - S->bmin[a]) / S->pas) + 1;
+        lo[a] = lo[a] < 0 ? 0 : lo[a];
+        hi[a] = hi[a] > S->n[a] ? S->n[a] : hi[a];
+        if (lo[a] >= hi[a])
+            return 0;
+    }
+    return 1;
+}
+
+// Plage [tlo,thi] (bornes comprises) des tuiles contenant les noeuds [lo,hi[.
+static void plageTuiles(const int lo[DIM], const int hi[DIM], int tlo[DIM], int thi[DIM]) {
+    for (int a = 0; a < DIM; ++a) {
+        tlo[a] = lo[a] / SDF_TUILE;
+        thi[a] = (hi[a] - 1) / SDF_TUILE + 1;
+    }
+}
+
+// Remet à la valeur "loin de tout" les noeuds [lo,hi[.
+static void videNoeuds(SDF *S, const int lo[DIM], const int hi[DIM]) {
+    int i[DIM];
+    memcpy(i, lo, sizeof(i));
+    do {
+        ValeurSDF *v = noeud(S, i);
+        v->d = S->bande;
+        for (int a = 0; a < DIM; ++a)
+            v->g[a] = 0.0;
+        v->att = 0.0;
+    } while (suivant(i, lo, hi));
+}
+
+// Rajoute l'obstacle o dans les noeuds [lo,hi[ (minimum des distances).
+static void rasterise(SDF *S, const Obstacle *o, const int lo[DIM], const int hi[DIM]) {
+    int i[DIM];
+    memcpy(i, lo, sizeof(i));
+    do {
+        ValeurSDF *v = noeud(S, i);
+        Point x, g;
+        for (int a = 0; a < DIM; ++a)
+            x.x[a] = S->bmin[a] + i[a] * S->pas;
+        double d = Obstacle_distance(o, x, &g);
+        if (d < v->d) {
+            v->d = d;
+            for (int a = 0; a < DIM; ++a)
+                v->g[a] = g.x[a];
+            v->att = o->att;
+        }
+    } while (suivant(i, lo, hi));
+}
+
+void SDF_Calcule(SDF *S) {
+    int nt = nbTuiles(S);
+    S->valeurs = Tableau_reserve(S->valeurs, &S->taille_valeurs, 0, nbNoeuds(S), sizeof(ValeurSDF));
+    S->sales = Tableau_reserve(S->sales, &S->taille_sales, 0, nt, sizeof(unsigned char));
+    memset(S->sales, 0, nt);
+    S->nb_sales = 0;
+    int zero[DIM] = {0};
+    videNoeuds(S, zero, S->n);
+    TabObstacles *O = S->index->O;
+    for (int k = 0; k < TabObstacles_nb(O); ++k) {
+        const Obstacle *o = TabObstacles_ref(O, k);
+        int lo[DIM], hi[DIM];
+        if (o->type != SEGMENT && plageNoeuds(S, o, lo, hi))
+            rasterise(S, o, lo, hi);
+    }
+    S->pret = 1;
+}
+
+void SDF_Marque(SDF *S, const Obstacle *o) {
+    int lo[DIM], hi[DIM], tlo[DIM], thi[DIM], t[DIM];
+    if (!S->pret || !plageNoeuds(S, o, lo, hi))
+        return;
+    plageTuiles(lo, hi, tlo, thi);
+    memcpy(t, tlo, sizeof(t));
+    do {
+        unsigned char *s = tuile(S, t);
+        S->nb_sales += !*s;
+        *s = 1;
+    } while (suivant(t, tlo, thi));
+}
+
+// Intersection des noeuds [lo,hi[ avec ceux de la tuile t.
+static int dansTuile(const int t[DIM], const int lo[DIM], const int hi[DIM],
+                     int nlo[DIM], int nhi[DIM]) {
+    for (int a = 0; a < DIM; ++a) {
+        nlo[a] = t[a] * SDF_TUILE > lo[a] ? t[a] * SDF_TUILE : lo[a];
+        nhi[a] = (t[a] + 1) * SDF_TUILE < hi[a] ? (t[a] + 1) * SDF_TUILE : hi[a];
+        if (nlo[a] >= nhi[a])
+            return 0;
+    }
+    return 1;
+}
+
+void SDF_MetAJour(SDF *S) {
+    if (!S->pret || S->nb_sales == 0)
+        return;
+    IndexObstacles *I = S->index;
+    int zero[DIM] = {0}, t[DIM], nlo[DIM], nhi[DIM];
+    memset(t, 0, sizeof(t));
+    do {
+        if (!*tuile(S, t) || !dansTuile(t, zero, S->n, nlo, nhi))
+            continue;
+        videNoeuds(S, nlo, nhi);
+        // Boule centrée sur la tuile qui contient tous les obstacles à moins de la bande de ses noeuds.
+        Point c;
+        double r2 = 0.0;
+        for (int a = 0; a < DIM; ++a) {
+            double demi = 0.5 * (nhi[a] - 1 - nlo[a]) * S->pas;
+            c.x[a] = S->bmin[a] + nlo[a] * S->pas + demi;
+            r2 += demi * demi;
+        }
+        TabObstacles_vide(&S->candidats);
+        KDT_DansBouleObstacles(&S->candidats, I->O->obstacles, Racine(I->kdtree), &c,
+                               sqrt(r2) + S->bande + I->r_max, 0);
+        for (int k = 0; k < TabObstacles_nb(&S->candidats); ++k) {
+            const Obstacle *o = TabObstacles_ref(&S->candidats, k);
+            int lo[DIM], hi[DIM], olo[DIM], ohi[DIM];
+            if (o->type != SEGMENT && plageNoeuds(S, o, lo, hi) && dansTuile(t, lo, hi, olo, ohi))
+                rasterise(S, o, olo, ohi);
+        }
+    } while (suivant(t, zero, S->nt));
+    memset(S->sales, 0, nbTuiles(S));
+    S->nb_sales = 0;
+}
+
+double SDF_Distance(const SDF *S, const Reel x[DIM], Point *grad, double *att) {
+    // Cellule i contenant x, et coordonnées u de x dans cette cellule.
+    int i[DIM];
+    double u[DIM];
+    int dedans = S->pret;
+    for (int a = 0; a < DIM; ++a) {
+        double f = (x[a] - S->bmin[a]) / S->pas;
+        dedans = dedans && f >= 0.0 && f < S->n[a] - 1;
+        i[a] = dedans ? (int) f : 0;
+        u[a] = f - i[a];
+    }
+    if (grad != NULL)
+        for (int a = 0; a < DIM; ++a)
+            grad->x[a] = 0.0;
+    if (!dedans) {
+        if (att != NULL) *att = 0.0;
+        return S->bande;
+    }
+    const ValeurSDF *base = S->valeurs;
+    for (int a = 0; a < DIM; ++a)
+        base += i[a] * S->saut[a];
+    // Somme sur les 2^DIM coins de la cellule, pondérés par leur poids multilinéaire.
+    double d = 0.0;
+    const ValeurSDF *proche = base;
+    for (int c = 0; c < (1 << DIM); ++c) {
+        const ValeurSDF *v = base;
+        double w = 1.0;
+        for (int a = 0; a < DIM; ++a)
+            if (c & (1 << a)) {
+                v += S->saut[a];
+                w *= u[a];
+            } else
+                w *= 1.0 - u[a];
+        d += w * v->d;
+        if (grad != NULL)
+            for (int a = 0; a < DIM; ++a)
+                grad->x[a] += w * v->g[a];
+        proche = v->d < proche->d ? v : proche;
+    }
+    if (att != NULL)
+        *att = proche->att;
+    return d;
+}
+
+int SDF_Rebond(const SDF *S, Particule *p, double dt) {
+    if (SDF_Distance(S, p->x, NULL, NULL) > 0.0)
+        return 0;
+    Reel xd[DIM];
+    for (int a = 0; a < DIM; ++a)
+        xd[a] = p->x[a] + dt * p->v[a];
+    Point g, vo = {{0.0}};
+    double att;
+    double d = SDF_Distance(S, xd, &g, &att);
+    if (Point_norm2(g) == 0.0)
+        return 0;
+    Point u = Point_normalize(g), q;
+    for (int a = 0; a < DIM; ++a)
+        q.x[a] = xd[a] - d * u.x[a];
+    *p = calculRebondNormal(*p, q, u, -d, att, vo);
+    return 1;
+}
+
+void SDF_termine(SDF *S) {
+    Tableau_libere(S->valeurs, &S->taille_valeurs, sizeof(ValeurSDF));
+    Tableau_libere(S->sales, &S->taille_sales, sizeof(unsigned char));
+    S->nb_sales = 0;
+    S->pret = 0;
+    TabObstacles_termine(&S->candidats);
+}
@@ -0,0 +1,98 @@
+#ifndef _SDF_H_
+#define _SDF_H_
+
+#include "points.h"
+#include "particules.h"
+#include "obstacles.h"
+#include "indexobstacles.h"
+
+/// Côté d'une tuile de la grille, en noeuds: c'est l'unité de mise à jour.
+/// La grille et ses tuiles ont la dimension DIM (carrés en 2D, cubes en 3D).
+#define SDF_TUILE 16
+
+/// La valeur du champ en un noeud de la grille.
+typedef struct SValeurSDF {
+    Reel d;         //< distance signée à l'obstacle le plus proche (bornée par la bande)
+    Reel g[DIM];    //< gradient de la distance (normale sortante), nul loin des obstacles
+    Reel att;       //< atténuation de l'obstacle le plus proche
+} ValeurSDF;
+
+/**
+   Un champ de distance signée (SDF) précalculé sur une grille régulière
+   couvrant le domaine. Chaque noeud stocke la distance à l'obstacle le
+   plus proche et son gradient: tester une collision ne coûte plus
+   qu'une interpolation bilinéaire, au lieu d'une recherche dans l'arbre
+   k-D suivie d'un calcul de distance par candidat.
+
+   Les distances ne sont calculées que dans une bande de largeur \a bande
+   autour des obstacles; au-delà, le champ vaut \a bande. Quand un
+   obstacle change, on marque les tuiles qu'il touche (SDF_Marque), et
+   seules celles-ci sont recalculées (SDF_MetAJour), avec les seuls
+   obstacles que l'arbre k-D trouve près de chacune.
+*/
+typedef struct SSDF {
+    IndexObstacles *index; //< les obstacles et leur arbre (ils n'appartiennent pas au champ)
+    double bmin[DIM];    //< coin inférieur du domaine
+    double pas;          //< distance entre deux noeuds voisins
+    double bande;        //< distance maximale représentée
+    int n[DIM];          //< nombre de noeuds selon chaque axe
+    int saut[DIM];       //< écart dans valeurs entre deux noeuds voisins selon chaque axe
+    int nt[DIM];         //< nombre de tuiles selon chaque axe
+    ValeurSDF *valeurs;  //< les noeuds, ligne par ligne (puis plan par plan en 3D)
+    int taille_valeurs;
+    unsigned char *sales; //< sales[t] est vrai si la tuile t est à recalculer
+    int taille_sales;
+    int nb_sales;
+    int pret;            //< vrai une fois le champ calculé une première fois
+    TabObstacles candidats; //< obstacles proches d'une tuile sale (mémoire réutilisée)
+} SDF;
+
+/**
+   Initialise un champ vide sur le domaine [bmin,bmax] pour les obstacles
+   indexés par \a I, avec des noeuds espacés de \a pas. Il ne sera
+   calculé qu'au premier appel à SDF_Calcule.
+*/
+void SDF_init(SDF *S, IndexObstacles *I, const double bmin[DIM], const double bmax[DIM],
+              double pas, double bande);
+
+/// Calcule tout le champ à partir des obstacles actuels.
+void SDF_Calcule(SDF *S);
+
+/**
+   Marque comme à recalculer les tuiles que l'obstacle \a o influence.
+   À appeler avec l'ancien et le nouvel état d'un obstacle modifié, avec
+   un obstacle ajouté, et avec un obstacle avant sa suppression. Ne fait
+   rien tant que le champ n'a pas été calculé.
+*/
+void SDF_Marque(SDF *S, const Obstacle *o);
+
+/**
+   Recalcule les tuiles marquées. Pour chacune, l'arbre k-D donne les
+   obstacles dont le centre est à moins de la demi-diagonale de la
+   tuile, plus la bande, plus index->r_max: eux seuls peuvent y être à
+   moins de la bande d'un noeud.
+*/
+void SDF_MetAJour(SDF *S);
+
+/**
+   Interpole le champ au point \a x (bilinéaire en 2D, trilinéaire en 3D).
+
+   @param grad si non NULL, reçoit le gradient interpolé.
+   @param att si non NULL, reçoit l'atténuation de l'obstacle le plus proche.
+   @return la distance signée interpolée (\a bande hors du domaine).
+*/
+double SDF_Distance(const SDF *S, const Reel x[DIM], Point *grad, double *att);
+
+/**
+   Gère la collision de la particule \a p avec les obstacles du champ:
+   si elle est dans un obstacle, elle rebondit sur la surface donnée
+   par le champ autour de sa position prédite p->x + dt p->v.
+
+   @return vrai s'il y a eu collision (p est alors déjà déplacée).
+*/
+int SDF_Rebond(const SDF *S, Particule *p, double dt);
+
+/// Libère la mémoire du champ (mais pas les obstacles ni leur index).
+void SDF_termine(SDF *S);
+
+#endif
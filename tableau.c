@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "tableau.h"
+
+// Un bloc de cette taille est-il projeté avec mmap ?
+static int estProjete(size_t octets) {
+    return octets >= TABLEAU_SEUIL_MMAP;
+}
+
+static void *alloue(size_t octets) {
+    void *p = NULL;
+    if (estProjete(octets)) {
+        p = mmap(NULL, octets, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(p != MAP_FAILED);
+    } else {
+        int res = posix_memalign(&p, TABLEAU_ALIGNEMENT, octets);
+        assert(res == 0);
+        (void) res;
+    }
+    return p;
+}
+
+static void libere(void *p, size_t octets) {
+    if (p == NULL) return;
+    if (estProjete(octets))
+        munmap(p, octets);
+    else
+        free(p);
+}
+
+void *Tableau_redimensionne(void *data, int *taille, int nb, int nouvelle, size_t elem) {
+    assert(nb <= nouvelle);
+    size_t ancien = (size_t) *taille * elem;
+    size_t octets = (size_t) nouvelle * elem;
+    void *p;
+    if (nouvelle == 0)
+        p = NULL;
+#ifdef MREMAP_MAYMOVE
+    else if (data != NULL && estProjete(ancien) && estProjete(octets)) {
+        // Les pages sont déplacées par le noyau, sans recopie.
+        p = mremap(data, ancien, octets, MREMAP_MAYMOVE);
+        assert(p != MAP_FAILED);
+        *taille = nouvelle;
+        return p;
+    }
+#endif
+    else {
+        p = alloue(octets);
+        if (nb > 0) memcpy(p, data, (size_t) nb * elem);
+    }
+    libere(data, ancien);
+    *taille = nouvelle;
+    return p;
+}
+
+void *Tableau_reserve(void *data, int *taille, int nb, int n, size_t elem) {
+    if (n <= *taille) return data;
+    return Tableau_redimensionne(data, taille, nb, n, elem);
+}
+
+void *Tableau_agrandir(void *data, int *taille, int nb, size_t elem) {
+    int nouvelle = *taille > 0 ? 2 * *taille : TABLEAU_TAILLE_MIN;
+    return Tableau_redimensionne(data, taille, nb, nouvelle, elem);
+}
+
+void *Tableau_ajuste(void *data, int *taille, int nb, size_t elem) {
+    if (nb == *taille) return data;
+    return Tableau_redimensionne(data, taille, nb, nb, elem);
+}
+
+void Tableau_libere(void *data, int *taille, size_t elem) {
+    libere(data, (size_t) *taille * elem);
+    *taille = 0;
+}
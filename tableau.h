@@ -0,0 +1,65 @@
+#ifndef _TABLEAU_H_
+#define _TABLEAU_H_
+
+#include <stddef.h>
+
+/**
+   Fonctions communes à tous les tableaux dynamiques (TabParticules,
+   TabObstacles, TabEmetteurs, ...). Chaque tableau typé garde ses
+   champs \a taille (capacité), \a nb et son pointeur de données, et
+   délègue ici la gestion de la mémoire en passant la taille \a elem
+   d'un élément.
+
+   Les données sont toujours alignées sur une ligne de cache. Les petits
+   tableaux sont alloués avec posix_memalign; au-delà de
+   TABLEAU_SEUIL_MMAP octets ils sont projetés en mémoire (mmap), et
+   agrandis par mremap: le noyau déplace les pages sans recopier les
+   données, ce qui évite les recopies complètes lorsqu'on monte à des
+   millions de particules.
+*/
+
+/// Alignement (en octets) des données des tableaux: une ligne de cache.
+#define TABLEAU_ALIGNEMENT 64
+
+/// Taille (en octets) à partir de laquelle un tableau est projeté avec mmap.
+#define TABLEAU_SEUIL_MMAP (1 << 20)
+
+/// Capacité donnée à un tableau vide lors de son premier agrandissement.
+#define TABLEAU_TAILLE_MIN 16
+
+/**
+   Change la capacité d'un tableau. Les \a nb premiers éléments sont
+   conservés.
+
+   @param data les données du tableau (NULL si sa capacité est nulle).
+   @param taille un pointeur vers la capacité du tableau, mise à jour.
+   @param nb le nombre d'éléments utiles (nb <= nouvelle).
+   @param nouvelle la nouvelle capacité.
+   @param elem la taille en octets d'un élément.
+   @return les nouvelles données du tableau (NULL si \a nouvelle est nulle).
+*/
+void *Tableau_redimensionne(void *data, int *taille, int nb, int nouvelle, size_t elem);
+
+/**
+   Garantit que le tableau peut contenir \a n éléments sans être
+   agrandi. Ne réduit jamais la capacité.
+*/
+void *Tableau_reserve(void *data, int *taille, int nb, int n, size_t elem);
+
+/**
+   Double la capacité du tableau (ou lui donne TABLEAU_TAILLE_MIN s'il
+   est vide).
+*/
+void *Tableau_agrandir(void *data, int *taille, int nb, size_t elem);
+
+/**
+   Réduit la capacité du tableau à son nombre d'éléments \a nb.
+*/
+void *Tableau_ajuste(void *data, int *taille, int nb, size_t elem);
+
+/**
+   Libère les données du tableau et met sa capacité à 0.
+*/
+void Tableau_libere(void *data, int *taille, size_t elem);
+
+#endif
@@ -0,0 +1,153 @@
+#include <string.h>
+#include <math.h>
+#include "trame.h"
+#include "tableau.h"
+
+void Trame_init(Trame *T) {
+    T->pas = 0;
+    T->nb_particules = 0;
+    T->nb_dormantes = 0;
+    T->taille_particules = 0;
+    T->particules = NULL;
+    T->taille_tampon = 0;
+    T->tampon = NULL;
+    for (int a = 0; a < 2; ++a) {
+        T->grille_min[a] = -1.0;
+        T->grille_max[a] = 1.0;
+    }
+    memset(T->debut_cellule, 0, sizeof(T->debut_cellule));
+    TabObstacles_init(&T->obstacles);
+    TabObstacles_init(&T->mobiles);
+    TabObstacles_init(&T->murs);
+    T->selection = -1;
+    T->version_arbre = -1;
+    T->nb_noeuds = 0;
+    T->taille_noeuds = 0;
+    T->noeuds = NULL;
+    T->profil[0] = '\0';
+}
+
+void Trame_reserve(Trame *T, int n) {
+    T->particules = Tableau_reserve(T->particules, &T->taille_particules, 0, n, sizeof(ParticuleTrame));
+    T->nb_particules = n;
+}
+
+// La colonne ou la ligne (selon l'axe a) de la grille où tombe la
+// coordonnée x, ramenée dans la grille.
+static int cellule(const Trame *T, double x, int a) {
+    double c = floor((x - T->grille_min[a]) * TRAME_GRILLE / (T->grille_max[a] - T->grille_min[a]));
+    return c < 0.0 ? 0 : c >= TRAME_GRILLE ? TRAME_GRILLE - 1 : (int) c;
+}
+
+static int celluleDe(const Trame *T, const ParticuleTrame *p) {
+    return cellule(T, p->y, 1) * TRAME_GRILLE + cellule(T, p->x, 0);
+}
+
+void Trame_grille(Trame *T, const double bmin[2], const double bmax[2]) {
+    for (int a = 0; a < 2; ++a) {
+        T->grille_min[a] = bmin[a];
+        T->grille_max[a] = bmax[a];
+    }
+    int *debut = T->debut_cellule;
+    memset(debut, 0, sizeof(T->debut_cellule));
+    for (int i = 0; i < T->nb_particules; ++i)
+        ++debut[celluleDe(T, T->particules + i) + 1];
+    for (int c = 0; c < TRAME_GRILLE * TRAME_GRILLE; ++c)
+        debut[c + 1] += debut[c];
+    // debut[c] sert de curseur pendant le rangement, puis est rétabli.
+    T->tampon = Tableau_reserve(T->tampon, &T->taille_tampon, 0, T->nb_particules, sizeof(ParticuleTrame));
+    for (int i = 0; i < T->nb_particules; ++i)
+        T->tampon[debut[celluleDe(T, T->particules + i)]++] = T->particules[i];
+    for (int c = TRAME_GRILLE * TRAME_GRILLE; c > 0; --c)
+        debut[c] = debut[c - 1];
+    debut[0] = 0;
+    // Le tampon devient le tableau des particules.
+    ParticuleTrame *tampon = T->tampon;
+    int taille = T->taille_tampon;
+    T->tampon = T->particules;
+    T->taille_tampon = T->taille_particules;
+    T->particules = tampon;
+    T->taille_particules = taille;
+}
+
+void Trame_plage(const Trame *T, const double bmin[2], const double bmax[2], int plage[4]) {
+    // Hors de la grille, les cellules du bord gardent les particules sorties.
+    plage[0] = cellule(T, bmin[0], 0);
+    plage[1] = cellule(T, bmax[0], 0);
+    plage[2] = cellule(T, bmin[1], 1);
+    plage[3] = cellule(T, bmax[1], 1);
+}
+
+// Recopie le sous-arbre de racine N à la fin des noeuds de T.
+// Retourne son nombre de noeuds.
+static int copieNoeuds(Trame *T, Noeud *N) {
+    if (N == ArbreVide())
+        return 0;
+    if (T->nb_noeuds == T->taille_noeuds)
+        T->noeuds = Tableau_agrandir(T->noeuds, &T->taille_noeuds, T->nb_noeuds, sizeof(NoeudTrame));
+    int i = T->nb_noeuds++;
+    const Reel *x = Position(N);
+    T->noeuds[i].x = (float) x[0];
+    T->noeuds[i].y = (float) x[1];
+    T->noeuds[i].indice = N->indice;
+    T->noeuds[i].supprime = N->supprime;
+    // Les appels récursifs peuvent déplacer T->noeuds.
+    int nb_gauche = copieNoeuds(T, Gauche(N));
+    int nb_droit = copieNoeuds(T, Droit(N));
+    T->noeuds[i].nb_gauche = nb_gauche;
+    T->noeuds[i].nb_droit = nb_droit;
+    return 1 + nb_gauche + nb_droit;
+}
+
+void Trame_copieArbre(Trame *T, Noeud *racine, int version) {
+    if (T->version_arbre == version)
+        return;
+    T->nb_noeuds = 0;
+    copieNoeuds(T, racine);
+    T->version_arbre = version;
+}
+
+void Trame_termine(Trame *T) {
+    Tableau_libere(T->particules, &T->taille_particules, sizeof(ParticuleTrame));
+    T->particules = NULL;
+    Tableau_libere(T->tampon, &T->taille_tampon, sizeof(ParticuleTrame));
+    T->tampon = NULL;
+    T->nb_particules = 0;
+    Tableau_libere(T->noeuds, &T->taille_noeuds, sizeof(NoeudTrame));
+    T->noeuds = NULL;
+    T->version_arbre = -1;
+    T->nb_noeuds = 0;
+    TabObstacles_termine(&T->obstacles);
+    TabObstacles_termine(&T->mobiles);
+    TabObstacles_termine(&T->murs);
+}
+
+void EchangeTrames_init(EchangeTrames *E) {
+    for (int k = 0; k < 3; ++k)
+        Trame_init(&E->trames[k]);
+    E->ecriture = 0;
+    E->partagee = 1;
+    E->lecture = 2;
+}
+
+Trame *EchangeTrames_aEcrire(EchangeTrames *E) {
+    return &E->trames[E->ecriture];
+}
+
+void EchangeTrames_publie(EchangeTrames *E) {
+    int ancienne = __atomic_exchange_n(&E->partagee, E->ecriture | TRAME_NOUVELLE, __ATOMIC_ACQ_REL);
+    E->ecriture = ancienne & ~TRAME_NOUVELLE;
+}
+
+Trame *EchangeTrames_derniere(EchangeTrames *E) {
+    if (__atomic_load_n(&E->partagee, __ATOMIC_ACQUIRE) & TRAME_NOUVELLE) {
+        int nouvelle = __atomic_exchange_n(&E->partagee, E->lecture, __ATOMIC_ACQ_REL);
+        E->lecture = nouvelle & ~TRAME_NOUVELLE;
+    }
+    return &E->trames[E->lecture];
+}
+
+void EchangeTrames_termine(EchangeTrames *E) {
+    for (int k = 0; k < 3; ++k)
+        Trame_termine(&E->trames[k]);
+}
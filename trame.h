@@ -0,0 +1,139 @@
+#ifndef _TRAME_H_
+#define _TRAME_H_
+
+#include "obstacles.h"
+#include "arbre.h"
+
+/// Ce qu'il faut pour dessiner une particule.
+typedef struct SParticuleTrame {
+    float x;
+    float y;
+    float m;
+    float v;  //< norme de la vitesse
+} ParticuleTrame;
+
+/**
+   Un noeud de l'arbre k-D des obstacles, tel qu'il est dessiné. Les
+   noeuds d'une trame sont rangés en ordre préfixe: le fils gauche du
+   noeud i (s'il existe) est en i+1, le fils droit en i+1+nb_gauche.
+   L'axe de coupe est la profondeur modulo DIM, comme dans l'arbre.
+*/
+typedef struct SNoeudTrame {
+    float x;
+    float y;
+    int indice;     //< l'indice de l'obstacle dans Trame::obstacles
+    int nb_gauche;  //< nombre de noeuds du sous-arbre gauche
+    int nb_droit;   //< nombre de noeuds du sous-arbre droit
+    int supprime;   //< vrai pour une pierre tombale
+} NoeudTrame;
+
+/// Taille du résumé du profileur recopié dans une trame.
+#define TRAME_TEXTE 1024
+
+/// Nombre de cellules de la grille des particules d'une trame, sur chaque axe.
+#define TRAME_GRILLE 64
+
+/**
+   Une image de la simulation à un instant donné: tout ce que
+   l'interface doit dessiner, recopié par le fil de simulation. Le fil
+   de l'interface ne lit jamais directement les données de la
+   simulation.
+
+   Les particules sont rangées cellule par cellule d'une grille
+   grossière (\ref Trame_grille), et les obstacles sont indexés par la
+   copie de leur arbre k-D: l'interface ne parcourt que ce qui est
+   visible.
+*/
+typedef struct STrame {
+    int pas;                      //< numéro du pas de temps
+    int nb_particules;
+    int nb_dormantes;
+    int taille_particules;
+    ParticuleTrame *particules;   //< positions (projetées sur xy), masses et vitesses
+    int taille_tampon;
+    ParticuleTrame *tampon;       //< pour ranger les particules par cellule
+    double grille_min[2];         //< le rectangle couvert par la grille
+    double grille_max[2];
+    int debut_cellule[TRAME_GRILLE * TRAME_GRILLE + 1]; //< la cellule (i,j) a les particules [debut[c],debut[c+1][, c = j*TRAME_GRILLE+i
+    TabObstacles obstacles;       //< les disques fixes
+    TabObstacles mobiles;         //< les obstacles mobiles
+    TabObstacles murs;            //< les segments, capsules et boîtes
+    int selection;                //< l'obstacle sélectionné, ou -1
+    int version_arbre;            //< la version de l'arbre k-D recopié (IndexObstacles::version), ou -1
+    int nb_noeuds;
+    int taille_noeuds;
+    NoeudTrame *noeuds;           //< l'arbre k-D des obstacles en ordre préfixe
+    char profil[TRAME_TEXTE];     //< le résumé du profileur de la simulation
+} Trame;
+
+/// Initialise une trame vide.
+void Trame_init(Trame *T);
+
+/// Garantit que la trame peut recevoir \a n particules, et fixe leur nombre.
+void Trame_reserve(Trame *T, int n);
+
+/**
+   Range les particules de la trame par cellule d'une grille de
+   TRAME_GRILLE x TRAME_GRILLE cellules sur le rectangle [bmin,bmax]
+   (tri par dénombrement, en O(n)). Les particules hors du rectangle
+   vont dans la cellule du bord la plus proche.
+*/
+void Trame_grille(Trame *T, const double bmin[2], const double bmax[2]);
+
+/**
+   Met dans plage les cellules de la grille qui touchent le rectangle
+   [bmin,bmax]: les colonnes plage[0] à plage[1] et les lignes plage[2]
+   à plage[3], bornes comprises. Les cellules du bord comptent pour
+   tout ce qui est au-delà.
+*/
+void Trame_plage(const Trame *T, const double bmin[2], const double bmax[2], int plage[4]);
+
+/**
+   Recopie dans la trame l'arbre k-D de racine \a racine, de version
+   \a version. La recopie n'est faite que si la trame n'a pas déjà
+   cette version: une trame réutilisée garde l'arbre qu'elle avait.
+*/
+void Trame_copieArbre(Trame *T, Noeud *racine, int version);
+
+/// Libère la mémoire de la trame.
+void Trame_termine(Trame *T);
+
+/**
+   Trois trames pour passer les images de la simulation à l'interface
+   sans verrou (triple tampon). Le producteur remplit sa trame puis
+   l'échange avec la trame partagée, marquée comme nouvelle; le
+   consommateur échange sa trame avec la partagée seulement si elle est
+   nouvelle. Chacun a donc toujours une trame à lui: la simulation
+   n'attend jamais l'affichage, et l'affichage prend toujours la
+   dernière image publiée (les intermédiaires sont sautées).
+*/
+typedef struct SEchangeTrames {
+    Trame trames[3];
+    int ecriture;   //< la trame du producteur
+    int partagee;   //< la trame échangée, plus TRAME_NOUVELLE si elle n'a pas été lue (accès atomiques)
+    int lecture;    //< la trame du consommateur
+} EchangeTrames;
+
+/// Bit de EchangeTrames::partagee qui indique une trame pas encore lue.
+#define TRAME_NOUVELLE 4
+
+/// Initialise les trois trames.
+void EchangeTrames_init(EchangeTrames *E);
+
+/// @return la trame à remplir par le producteur.
+Trame *EchangeTrames_aEcrire(EchangeTrames *E);
+
+/// Publie la trame remplie par le producteur, qui en reçoit une autre à remplir.
+void EchangeTrames_publie(EchangeTrames *E);
+
+/**
+   @return la dernière trame publiée (ou la même que la fois précédente
+   s'il n'y en a pas de nouvelle). Elle reste valide jusqu'au prochain
+   appel (consommateur seulement).
+*/
+Trame *EchangeTrames_derniere(EchangeTrames *E);
+
+/// Libère les trois trames.
+void EchangeTrames_termine(EchangeTrames *E);
+
+#endif